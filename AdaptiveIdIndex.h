@@ -0,0 +1,254 @@
+#ifndef ADAPTIVEIDINDEX_H
+#define ADAPTIVEIDINDEX_H
+#define DENSE_FACTOR 4
+#define DENSE_SLACK 1024
+
+#include <memory>
+#include "DoubleHashTable.h"
+
+using namespace std;
+
+// id -> value index with the DoubleHashTable interface.
+// while the ids are dense (the largest id is at most DENSE_FACTOR times the
+// number of ids, plus DENSE_SLACK) the value of id i sits at cell i of a flat
+// array. the first id that breaks that rule moves everything to a
+// DoubleHashTable. the hash form looks at its ids again each time their count
+// doubles and goes back to the flat array once they are dense, so dense ids
+// that come in any order end up flat. a cell holding -1 is empty, same as
+// find's answer
+template <typename K, typename V>
+class AdaptiveIdIndex {
+    V* dense;
+    int denseCapacity;
+    int size;
+    unique_ptr<DoubleHashTable<K, V>> sparse;
+    int nextCheck; // hash form: the count at which the ids are looked at again
+
+    AdaptiveIdIndex(const AdaptiveIdIndex&) = delete;
+    AdaptiveIdIndex& operator=(const AdaptiveIdIndex&) = delete;
+
+    // the largest id n ids may have and still be dense
+    static long long denseBound(int n) {
+        return (long long)DENSE_FACTOR * n + DENSE_SLACK;
+    }
+
+    bool fitsDense(const K& key) const {
+        if (key < 0) return false;
+        return (long long)key < denseBound(size + 1);
+    }
+
+    // make the flat array cover key, growing at least 2x at a time
+    void growDense(const K& key) {
+        long long wanted = (long long)denseCapacity * 2;
+        if (wanted <= key) wanted = (long long)key + 1;
+        long long bound = denseBound(size + 1);
+        if (wanted > bound) wanted = bound;
+        int newCapacity = (int)wanted;
+
+        V* temp = new V[newCapacity];
+        for (int i = 0; i < denseCapacity; i++) temp[i] = dense[i];
+        for (int i = denseCapacity; i < newCapacity; i++) temp[i] = -1;
+        delete[] dense;
+        dense = temp;
+        denseCapacity = newCapacity;
+    }
+
+    // move every id into a hash table and stop using the flat array
+    void goSparse() {
+        unique_ptr<DoubleHashTable<K, V>> table(new DoubleHashTable<K, V>(2 * size + 11));
+        for (int i = 0; i < denseCapacity; i++) {
+            if (dense[i] != -1) table->insert((K)i, dense[i]);
+        }
+        sparse = move(table);
+        delete[] dense;
+        dense = nullptr;
+        denseCapacity = 0;
+        nextCheck = 2 * size + 1;
+    }
+
+    // hash form, before key goes in: once the count has doubled since the
+    // last look, move back to a flat array if the ids and key are dense. the
+    // scan is paid once per doubling. nothing changes if it throws
+    void maybeGoDense(const K& key) {
+        if (size + 1 < nextCheck) return;
+        nextCheck = 2 * (size + 1);
+        bool fits = key >= 0;
+        long long largest = key;
+        sparse->for_each([&](const K& id, const V&) {
+            if (id < 0) fits = false;
+            if (id > largest) largest = id;
+        });
+        if (!fits || largest >= denseBound(size + 1)) return;
+
+        int newCapacity = (int)largest + 1;
+        V* cells = new V[newCapacity];
+        for (int i = 0; i < newCapacity; i++) cells[i] = -1;
+        sparse->for_each([&](const K& id, const V& value) {
+            cells[id] = value;
+        });
+        dense = cells;
+        denseCapacity = newCapacity;
+        sparse.reset();
+    }
+
+public:
+    AdaptiveIdIndex() : dense(nullptr), denseCapacity(0), size(0), sparse(nullptr), nextCheck(0) {}
+
+    ~AdaptiveIdIndex() {
+        delete[] dense;
+    }
+
+    bool isDense() const {
+        return !sparse;
+    }
+
+    // same contract as DoubleHashTable::try_emplace
+    V& try_emplace(const K& key, bool& inserted) {
+        if (sparse) maybeGoDense(key);
+        if (!sparse) {
+            if (key >= 0 && key < denseCapacity) {
+                inserted = (dense[key] == -1);
+                if (inserted) {
+                    dense[key] = V();
+                    size++;
+                }
+                return dense[key];
+            }
+            if (fitsDense(key)) {
+                growDense(key);
+                inserted = true;
+                dense[key] = V();
+                size++;
+                return dense[key];
+            }
+            goSparse();
+        }
+        V& slot = sparse->try_emplace(key, inserted);
+        if (inserted) size++;
+        return slot;
+    }
+
+    void insert(const K& key, const V& value) {
+        bool inserted = false;
+        try_emplace(key, inserted) = value;
+    }
+
+    // make the next extra inserts rehash nothing. the flat array is sized by
+    // the ids themselves, not by their number, so it is left to grow
+    void reserve(int extra) {
+        if (sparse) sparse->reserve(size + extra);
+    }
+
+    // same contract as DoubleHashTable::lookup
+    V* lookup(const K& key) {
+        if (!sparse) {
+            if (key < 0 || key >= denseCapacity || dense[key] == -1) return nullptr;
+            return &dense[key];
+        }
+        return sparse->lookup(key);
+    }
+
+    V find(const K& key) const {
+        if (!sparse) {
+            if (key < 0 || key >= denseCapacity) return -1;
+            return dense[key];
+        }
+        return sparse->find(key);
+    }
+
+    // same contract as DoubleHashTable::find_batch
+    void find_batch(const K* queries, V* out, size_t n) const {
+        if (sparse) {
+            sparse->find_batch(queries, out, n);
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            const K& key = queries[i];
+            out[i] = (key < 0 || key >= denseCapacity) ? -1 : dense[key];
+        }
+    }
+
+    void remove(const K& key) {
+        if (!sparse) {
+            if (key < 0 || key >= denseCapacity || dense[key] == -1) return;
+            dense[key] = -1;
+            size--;
+            return;
+        }
+        if (sparse->find(key) == -1) return;
+        sparse->remove(key);
+        size--;
+    }
+
+    int count() const {
+        return size;
+    }
+
+    // visit(key, value) for every entry, in no particular order
+    template <class F>
+    void for_each(F visit) const {
+        if (sparse) {
+            sparse->for_each(visit);
+            return;
+        }
+        for (int i = 0; i < denseCapacity; i++) {
+            if (dense[i] != -1) visit((K)i, dense[i]);
+        }
+    }
+
+    void swap(AdaptiveIdIndex& other) {
+        V* tempDense = dense;
+        dense = other.dense;
+        other.dense = tempDense;
+        int temp = denseCapacity;
+        denseCapacity = other.denseCapacity;
+        other.denseCapacity = temp;
+        temp = size;
+        size = other.size;
+        other.size = temp;
+        temp = nextCheck;
+        nextCheck = other.nextCheck;
+        other.nextCheck = temp;
+        sparse.swap(other.sparse);
+    }
+
+    // whichever form is in use, as it is. load replaces the index, throws
+    // FAILURE on a short or inconsistent stream and then leaves it as it was
+    void save(SnapshotWriter& out) const {
+        out.writeInt(sparse ? 1 : 0);
+        out.writeInt(size);
+        if (sparse) {
+            sparse->save(out);
+            return;
+        }
+        out.writeInt(denseCapacity);
+        out.write(dense, sizeof(V) * denseCapacity);
+    }
+
+    void load(SnapshotReader& in) {
+        int isSparse = in.readInt();
+        int newSize = in.readInt();
+        if ((isSparse != 0 && isSparse != 1) || newSize < 0) throw StatusType::FAILURE;
+        AdaptiveIdIndex index;
+        if (isSparse) {
+            index.sparse.reset(new DoubleHashTable<K, V>());
+            index.sparse->load(in);
+            index.nextCheck = 2 * newSize + 1;
+        }
+        else {
+            int newCapacity = in.readInt();
+            if (newCapacity < 0 || newCapacity < newSize) throw StatusType::FAILURE;
+            const void* cells = in.read(sizeof(V) * (size_t)newCapacity);
+            index.dense = new V[newCapacity];
+            index.denseCapacity = newCapacity;
+            memcpy(index.dense, cells, sizeof(V) * newCapacity);
+        }
+        int entries = 0;
+        index.for_each([&](const K&, const V&) { entries++; });
+        if (entries != newSize) throw StatusType::FAILURE;
+        index.size = newSize;
+        swap(index);
+    }
+};
+
+#endif //ADAPTIVEIDINDEX_H
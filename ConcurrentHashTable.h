@@ -0,0 +1,278 @@
+#ifndef CONCURRENTHASHTABLE_H
+#define CONCURRENTHASHTABLE_H
+#define CONCURRENT_LOAD_FACTOR 0.5
+#define LOCK_STRIPES 64
+
+#include <atomic>
+#include <cstdint>
+#include "wet2util.h"
+
+using namespace std;
+
+// hash table with the DoubleHashTable interface that can be shared between
+// threads. find never blocks: every slot is one 64 bit atomic word holding
+// key and value together, so a reader sees either the whole entry or none of it.
+// writers lock one stripe chosen by the key, a resize locks every stripe.
+// replaced arrays stay alive until reclaim() so late readers never touch freed memory.
+// keys 0 (empty slot) and the minimal value (deleted slot) are reserved: inserting
+// one throws INVALID_INPUT, find and remove treat them as missing
+template <typename K, typename V>
+class ConcurrentHashTable {
+    static_assert(sizeof(K) == 4 && sizeof(V) == 4, "key and value are packed into one 64 bit word");
+
+private:
+    static const uint32_t EMPTY_KEY = 0;
+    static const uint32_t DELETED_KEY = 0x80000000u;
+
+    struct Table {
+        atomic<uint64_t>* slots;
+        int capacity; // always a power of 2
+        int shift;    // 32 - log2(capacity)
+        Table* older; // chain of replaced tables waiting for reclaim()
+
+        explicit Table(int capacity) : capacity(capacity), shift(32), older(nullptr) {
+            for (int c = 1; c < capacity; c *= 2) shift--;
+            slots = new atomic<uint64_t>[capacity];
+            for (int i = 0; i < capacity; i++) slots[i].store(0, memory_order_relaxed);
+        }
+        ~Table() {
+            delete[] slots;
+        }
+    };
+
+    atomic<Table*> table;
+    atomic<int> size; // occupied slots
+    atomic<int> used; // occupied and deleted slots, decides when to resize
+    atomic<bool> stripes[LOCK_STRIPES];
+    Table* retired;
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    static uint32_t mix(const K& key) {
+        return static_cast<uint32_t>(key) * 2654435769u;
+    }
+
+    static uint64_t pack(uint32_t key, const V& value) {
+        return ((uint64_t)key << 32) | static_cast<uint32_t>(value);
+    }
+
+    static uint32_t keyOf(uint64_t word) {
+        return (uint32_t)(word >> 32);
+    }
+
+    static V valueOf(uint64_t word) {
+        return (V)(uint32_t)word;
+    }
+
+    static int home(const Table* t, const K& key) {
+        if (t->shift == 32) return 0;
+        return (int)(mix(key) >> t->shift);
+    }
+
+    static bool reserved(const K& key) {
+        uint32_t k = static_cast<uint32_t>(key);
+        return k == EMPTY_KEY || k == DELETED_KEY;
+    }
+
+    static int stripeOf(const K& key) {
+        return (int)(mix(key) & (LOCK_STRIPES - 1));
+    }
+
+    void lock(int stripe) {
+        while (stripes[stripe].exchange(true, memory_order_acquire)) {
+            while (stripes[stripe].load(memory_order_relaxed)) {}
+        }
+    }
+
+    void unlock(int stripe) {
+        stripes[stripe].store(false, memory_order_release);
+    }
+
+    // the caller holds the stripe of key. writes key -> value unless the key
+    // exists and overwrite is false. return 1 if the key was inserted, 0 if it
+    // existed and -1 if there was no free slot left for it
+    int put(const K& key, const V& value, bool overwrite) {
+        uint32_t k = static_cast<uint32_t>(key);
+        while (true) {
+            Table* t = table.load(memory_order_acquire);
+            int mask = t->capacity - 1;
+            int current = home(t, key);
+            int target = -1;
+            uint64_t targetWord = 0;
+
+            for (int i = 0; i < t->capacity; i++) {
+                uint64_t word = t->slots[current].load(memory_order_acquire);
+                uint32_t slotKey = keyOf(word);
+                if (slotKey == k) {
+                    // only writers of this stripe touch this key, a plain store is enough
+                    if (overwrite) t->slots[current].store(pack(k, value), memory_order_release);
+                    return 0;
+                }
+                if (slotKey == EMPTY_KEY) {
+                    if (target == -1) {
+                        target = current;
+                        targetWord = word;
+                    }
+                    break;
+                }
+                if (slotKey == DELETED_KEY && target == -1) {
+                    target = current;
+                    targetWord = word;
+                }
+                current = (current + 1) & mask;
+            }
+            if (target == -1) return -1;
+
+            // writers of other stripes may race for the same free slot
+            if (t->slots[target].compare_exchange_strong(targetWord, pack(k, value),
+                                                         memory_order_acq_rel)) {
+                if (keyOf(targetWord) == EMPTY_KEY) used.fetch_add(1, memory_order_relaxed);
+                size.fetch_add(1, memory_order_relaxed);
+                return 1;
+            }
+        }
+    }
+
+    // grow (or just drop the tombstones) while every writer is locked out
+    void resize(bool force) {
+        for (int i = 0; i < LOCK_STRIPES; i++) lock(i);
+
+        Table* old = table.load(memory_order_relaxed);
+        if (force || used.load(memory_order_relaxed) >= old->capacity * CONCURRENT_LOAD_FACTOR) {
+            int live = size.load(memory_order_relaxed);
+            int capacity = old->capacity;
+            while (live >= capacity * CONCURRENT_LOAD_FACTOR / 2) capacity *= 2;
+
+            Table* fresh = new Table(capacity);
+            int mask = capacity - 1;
+            for (int i = 0; i < old->capacity; i++) {
+                uint64_t word = old->slots[i].load(memory_order_relaxed);
+                uint32_t slotKey = keyOf(word);
+                if (slotKey == EMPTY_KEY || slotKey == DELETED_KEY) continue;
+                int current = home(fresh, (K)slotKey);
+                while (keyOf(fresh->slots[current].load(memory_order_relaxed)) != EMPTY_KEY) {
+                    current = (current + 1) & mask;
+                }
+                fresh->slots[current].store(word, memory_order_relaxed);
+            }
+            used.store(live, memory_order_relaxed);
+
+            old->older = retired;
+            retired = old;
+            table.store(fresh, memory_order_release);
+        }
+
+        for (int i = LOCK_STRIPES - 1; i >= 0; i--) unlock(i);
+    }
+
+    void resizeIfNeeded() {
+        Table* t = table.load(memory_order_acquire);
+        if (used.load(memory_order_relaxed) >= t->capacity * CONCURRENT_LOAD_FACTOR) {
+            resize(false);
+        }
+    }
+
+    // a full table can only happen when many writers race past the load
+    // factor at once - grow and try again
+    int putOrGrow(const K& key, const V& value, bool overwrite) {
+        int stripe = stripeOf(key);
+        while (true) {
+            lock(stripe);
+            int result = put(key, value, overwrite);
+            unlock(stripe);
+            if (result != -1) return result;
+            resize(true);
+        }
+    }
+
+public:
+    ConcurrentHashTable(int initCapacity = 16) : size(0), used(0), retired(nullptr) {
+        int capacity = 1;
+        while (capacity < initCapacity) capacity *= 2;
+        table.store(new Table(capacity), memory_order_relaxed);
+        for (int i = 0; i < LOCK_STRIPES; i++) stripes[i].store(false, memory_order_relaxed);
+    }
+
+    ~ConcurrentHashTable() {
+        reclaim();
+        delete table.load(memory_order_relaxed);
+    }
+
+    void insert(const K& key, const V& value) {
+        if (reserved(key)) throw StatusType::INVALID_INPUT;
+        if (putOrGrow(key, value, true) == 1) resizeIfNeeded();
+    }
+
+    // insert only if the key is missing, return true if it was inserted.
+    // this is the shared-table form of try_emplace - a slot reference would
+    // not survive a concurrent resize
+    bool try_insert(const K& key, const V& value) {
+        if (reserved(key)) throw StatusType::INVALID_INPUT;
+        bool inserted = putOrGrow(key, value, false) == 1;
+        if (inserted) resizeIfNeeded();
+        return inserted;
+    }
+
+    // lock free, safe against any concurrent writer
+    V find(const K& key) const {
+        if (reserved(key)) return -1;
+        uint32_t k = static_cast<uint32_t>(key);
+        const Table* t = table.load(memory_order_acquire);
+        int mask = t->capacity - 1;
+        int current = home(t, key);
+        for (int i = 0; i < t->capacity; i++) {
+            uint64_t word = t->slots[current].load(memory_order_acquire);
+            uint32_t slotKey = keyOf(word);
+            if (slotKey == k) return valueOf(word);
+            if (slotKey == EMPTY_KEY) return -1;
+            current = (current + 1) & mask;
+        }
+        return -1;
+    }
+
+    void remove(const K& key) {
+        if (reserved(key)) return;
+        uint32_t k = static_cast<uint32_t>(key);
+        int stripe = stripeOf(key);
+        lock(stripe);
+        Table* t = table.load(memory_order_acquire);
+        int mask = t->capacity - 1;
+        int current = home(t, key);
+        for (int i = 0; i < t->capacity; i++) {
+            uint64_t word = t->slots[current].load(memory_order_acquire);
+            uint32_t slotKey = keyOf(word);
+            if (slotKey == EMPTY_KEY) break;
+            if (slotKey == k) {
+                t->slots[current].store(pack(DELETED_KEY, 0), memory_order_release);
+                size.fetch_sub(1, memory_order_relaxed);
+                break;
+            }
+            current = (current + 1) & mask;
+        }
+        unlock(stripe);
+    }
+
+    int count() const {
+        return size.load(memory_order_relaxed);
+    }
+
+    // free the arrays replaced by resizes. find takes no lock and may still be
+    // probing one of them, so this is only safe at a quiescent point: no find
+    // running or about to load the table it saw before, e.g. once the reader
+    // threads are joined or parked between phases. writers may keep running,
+    // the retired list is taken under every stripe
+    void reclaim() {
+        for (int i = 0; i < LOCK_STRIPES; i++) lock(i);
+        Table* list = retired;
+        retired = nullptr;
+        for (int i = LOCK_STRIPES - 1; i >= 0; i--) unlock(i);
+        while (list) {
+            Table* next = list->older;
+            delete list;
+            list = next;
+        }
+    }
+};
+
+#endif //CONCURRENTHASHTABLE_H
@@ -0,0 +1,391 @@
+#ifndef CONCURRENTUNION_H
+#define CONCURRENTUNION_H
+#define CUNION_FIRST_CHUNK_BITS 10
+#define CUNION_FIRST_CHUNK (1 << CUNION_FIRST_CHUNK_BITS)
+#define CUNION_DIRECTORY (31 - CUNION_FIRST_CHUNK_BITS)
+
+#include <atomic>
+#include <new>
+#include "wet2util.h"
+#include "NenVector.h"
+
+using namespace std;
+
+// Union for several threads at once, same semantics and offsets as Union.h.
+//
+// a node's parent, fight offset and nen offset sit together in an immutable
+// CLink record behind one atomic pointer, so a reader always sees the three
+// from the same moment. a change builds a new record and swaps the pointer in:
+//  - find is lock-free. it splits paths by CASing a node to a record that
+//    skips to the grandparent, with the two offsets summed. a split keeps
+//    every node's total offset to its root, so a failed CAS is just skipped
+//  - combine, addFight, add_exp and kill lock the roots they change (lower
+//    index first, so two writers never wait on each other in a cycle) and
+//    recheck that they are still roots. a combine can rewrite both root
+//    records, the winner's is published before the loser is linked under it,
+//    so a reader walking through the loser already finds the new winner.
+//    the winner is still picked by size, as in Union, so answers match it
+// replaced records are retired, not freed, since a reader may still hold
+// them. reclaim() moves them to a free list once no other thread is inside
+// the union, and new records are taken from there before the heap, so a
+// steady workload stops allocating. splits are only an optimisation: once
+// the retired list holds as many records as there are nodes they are
+// skipped until the next reclaim, so between two reclaims the list grows
+// with the writes only (at most three records each).
+// squads that never share a root never share a lock
+struct CLink {
+    int parent;
+    int fights;       // relative to the parent, absolute at a root
+    NenVector nen;    // relative to the parent, absolute at a root
+    // next on the retired or free list. atomic since a thread that lost a
+    // pop from the free list may still read it after another took the record
+    atomic<CLink*> next;
+    CLink(int parent, int fights, const NenVector& nen)
+        : parent(parent), fights(fights), nen(nen), next(nullptr) {}
+};
+
+template <class T>
+class ConcurrentUnion {
+    struct Node {
+        atomic<CLink*> link;
+        atomic<bool> locked;
+        atomic<bool> alive;
+        // meaningful only while the node is a root, written under its lock
+        atomic<int> size;
+        atomic<int> experience;
+        atomic<int> lastChrono;
+        NenVector groupNen; // only touched by combine, under the lock
+        T value;
+        Node() : link(nullptr), locked(false), alive(false), size(0),
+                 experience(0), lastChrono(0) {}
+    };
+
+    atomic<Node*> chunks[CUNION_DIRECTORY];
+    atomic<int> nextIdx;
+    atomic<CLink*> retired;
+    atomic<int> retiredCount;
+    // only popped while the union is in use, only pushed by reclaim, so a
+    // pop never sees a record come back (no ABA)
+    atomic<CLink*> freeList;
+
+    ConcurrentUnion(const ConcurrentUnion&) = delete;
+    ConcurrentUnion& operator=(const ConcurrentUnion&) = delete;
+
+    static int highestBit(unsigned int n) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 31 - __builtin_clz(n);
+#else
+        int bit = 0;
+        while (n >>= 1) bit++;
+        return bit;
+#endif
+    }
+
+    Node& node(int idx) {
+        unsigned int j = (unsigned int)idx + CUNION_FIRST_CHUNK;
+        int bit = highestBit(j);
+        return chunks[bit - CUNION_FIRST_CHUNK_BITS].load(memory_order_acquire)[j - (1u << bit)];
+    }
+
+    // make sure the chunk holding idx exists, racing threads agree by CAS
+    void reserve(int idx) {
+        int chunk = highestBit((unsigned int)idx + CUNION_FIRST_CHUNK) - CUNION_FIRST_CHUNK_BITS;
+        if (chunk >= CUNION_DIRECTORY) throw bad_alloc();
+        if (chunks[chunk].load(memory_order_acquire)) return;
+        Node* fresh = new Node[CUNION_FIRST_CHUNK << chunk];
+        Node* expected = nullptr;
+        if (!chunks[chunk].compare_exchange_strong(expected, fresh, memory_order_acq_rel)) {
+            delete[] fresh;
+        }
+    }
+
+    // a record from the free list, or from the heap (nullptr if that fails
+    // and fallible is set)
+    CLink* makeLink(int parent, int fights, const NenVector& nen, bool fallible = false) {
+        CLink* link = freeList.load(memory_order_acquire);
+        while (link && !freeList.compare_exchange_weak(link, link->next.load(memory_order_relaxed),
+                                                       memory_order_acquire, memory_order_acquire)) {}
+        if (!link) return fallible ? new (nothrow) CLink(parent, fights, nen) : new CLink(parent, fights, nen);
+        link->parent = parent;
+        link->fights = fights;
+        link->nen = nen;
+        return link;
+    }
+
+    // records never go back to the heap while the union is in use, even
+    // ones no reader saw: a losing pop may still read their next
+    void retire(CLink* link) {
+        retiredCount.fetch_add(1, memory_order_relaxed);
+        CLink* head = retired.load(memory_order_relaxed);
+        do {
+            link->next.store(head, memory_order_relaxed);
+        } while (!retired.compare_exchange_weak(head, link, memory_order_release, memory_order_relaxed));
+    }
+
+    bool maySplit() const {
+        return retiredCount.load(memory_order_relaxed) < nextIdx.load(memory_order_relaxed);
+    }
+
+    static void freeAll(CLink* link) {
+        while (link) {
+            CLink* next = link->next.load(memory_order_relaxed);
+            delete link;
+            link = next;
+        }
+    }
+
+    // swap in a new record for a locked root
+    void publish(int idx, CLink* link) {
+        retire(node(idx).link.exchange(link, memory_order_acq_rel));
+    }
+
+    bool isRoot(int idx) {
+        return node(idx).link.load(memory_order_acquire)->parent == idx;
+    }
+
+    void lock(int idx) {
+        atomic<bool>& flag = node(idx).locked;
+        while (flag.exchange(true, memory_order_acquire)) {
+            while (flag.load(memory_order_relaxed)) {}
+        }
+    }
+
+    void unlock(int idx) {
+        node(idx).locked.store(false, memory_order_release);
+    }
+
+    // lock the root of idx, returns it
+    int lockRoot(int idx) {
+        while (true) {
+            int root = find(idx);
+            lock(root);
+            if (isRoot(root)) return root;
+            unlock(root);
+        }
+    }
+
+    // lock the roots of idx1 and idx2, lower index first. returns with both
+    // locked (once if they are the same root)
+    void lockRoots(int idx1, int idx2, int& root1, int& root2) {
+        while (true) {
+            root1 = find(idx1);
+            root2 = find(idx2);
+            int low = root1 < root2 ? root1 : root2;
+            int high = root1 < root2 ? root2 : root1;
+            lock(low);
+            if (high != low) lock(high);
+            if (isRoot(low) && isRoot(high)) return;
+            if (high != low) unlock(high);
+            unlock(low);
+        }
+    }
+
+public:
+    ConcurrentUnion() : nextIdx(0), retired(nullptr), retiredCount(0), freeList(nullptr) {
+        for (int k = 0; k < CUNION_DIRECTORY; k++) chunks[k].store(nullptr, memory_order_relaxed);
+    }
+
+    ~ConcurrentUnion() {
+        freeAll(retired.load(memory_order_relaxed));
+        freeAll(freeList.load(memory_order_relaxed));
+        for (int k = 0; k < CUNION_DIRECTORY; k++) {
+            Node* chunk = chunks[k].load(memory_order_relaxed);
+            if (!chunk) continue;
+            for (int i = 0; i < (CUNION_FIRST_CHUNK << k); i++) {
+                delete chunk[i].link.load(memory_order_relaxed);
+            }
+            delete[] chunk;
+        }
+    }
+
+    // safe from any thread. the node is ready once this returns, other
+    // threads may use the index from then on
+    int makeSet(T value) {
+        int idx = nextIdx.fetch_add(1, memory_order_relaxed);
+        reserve(idx);
+        Node& n = node(idx);
+        n.link.store(makeLink(idx, value.getFights(), value.getNenAbility()), memory_order_relaxed);
+        n.size.store(1, memory_order_relaxed);
+        n.experience.store(0, memory_order_relaxed);
+        n.lastChrono.store(idx, memory_order_relaxed);
+        n.value = move(value);
+        n.alive.store(true, memory_order_release);
+        return idx;
+    }
+
+    int find(int idx) {
+        int fightsAcc;
+        NenVector nenAcc;
+        return find(idx, fightsAcc, nenAcc);
+    }
+
+    // root of idx, plus the offsets between idx and the root. lock-free
+    int find(int idx, int& fightsAcc, NenVector& nenAcc) {
+        fightsAcc = 0;
+        nenAcc = NenVector();
+        while (true) {
+            CLink* link = node(idx).link.load(memory_order_acquire);
+            int parent = link->parent;
+            if (parent == idx) return idx;
+            fightsAcc += link->fights;
+            nenAcc += link->nen;
+            CLink* up = node(parent).link.load(memory_order_acquire);
+            if (up->parent != parent && maySplit()) {
+                // path splitting, skipped if memory is short or another thread got there first
+                CLink* skip = makeLink(up->parent, link->fights + up->fights, link->nen + up->nen, true);
+                if (skip) {
+                    if (node(idx).link.compare_exchange_strong(link, skip, memory_order_acq_rel)) retire(link);
+                    else retire(skip);
+                }
+            }
+            idx = parent;
+        }
+    }
+
+    int fightsHad(int idx) {
+        int fightsAcc;
+        NenVector nenAcc;
+        while (true) {
+            int root = find(idx, fightsAcc, nenAcc);
+            CLink* link = node(root).link.load(memory_order_acquire);
+            if (link->parent == root) return link->fights + fightsAcc;
+        }
+    }
+
+    NenVector partialAbility(int idx) {
+        int fightsAcc;
+        NenVector nenAcc;
+        while (true) {
+            int root = find(idx, fightsAcc, nenAcc);
+            CLink* link = node(root).link.load(memory_order_acquire);
+            if (link->parent == root) return link->nen + nenAcc;
+        }
+    }
+
+    void addFight(int idx1, int idx2) {
+        int root1, root2;
+        lockRoots(idx1, idx2, root1, root2);
+        CLink* link1 = node(root1).link.load(memory_order_relaxed);
+        publish(root1, makeLink(root1, link1->fights + 1, link1->nen));
+        CLink* link2 = node(root2).link.load(memory_order_relaxed);
+        publish(root2, makeLink(root2, link2->fights + 1, link2->nen));
+        if (root1 != root2) unlock(root2);
+        unlock(root1);
+    }
+
+    int get_exp(int idx) {
+        while (true) {
+            int root = find(idx);
+            int exp = node(root).experience.load(memory_order_acquire);
+            if (isRoot(root)) return exp;
+        }
+    }
+
+    void add_exp(int idx, int exp) {
+        int root = lockRoot(idx);
+        node(root).experience.fetch_add(exp, memory_order_acq_rel);
+        unlock(root);
+    }
+
+    void kill(int idx) {
+        if (idx == -1) throw StatusType::FAILURE;
+        int root = lockRoot(idx);
+        node(root).alive.store(false, memory_order_release);
+        unlock(root);
+    }
+
+    bool is_alive(int idx) {
+        while (true) {
+            int root = find(idx);
+            bool alive = node(root).alive.load(memory_order_acquire);
+            if (isRoot(root)) return alive;
+        }
+    }
+
+    int lastChrono(int idx) {
+        while (true) {
+            int root = find(idx);
+            int last = node(root).lastChrono.load(memory_order_acquire);
+            if (isRoot(root)) return last;
+        }
+    }
+
+    void combine(int idx1, int idx2, int order) {
+        int rIdx1, rIdx2;
+        lockRoots(idx1, idx2, rIdx1, rIdx2);
+        if (rIdx1 == rIdx2) {
+            unlock(rIdx1);
+            throw StatusType::FAILURE;
+        }
+        Node& set1 = node(rIdx1);
+        Node& set2 = node(rIdx2);
+        CLink* link1 = set1.link.load(memory_order_relaxed);
+        CLink* link2 = set2.link.load(memory_order_relaxed);
+        int size1 = set1.size.load(memory_order_relaxed);
+        int size2 = set2.size.load(memory_order_relaxed);
+        // both records are built before anything changes, so a failed
+        // allocation leaves the two sets as they were
+        CLink* loser = nullptr;
+        CLink* winner = nullptr;
+        try {
+            if (size1 >= size2) {
+                NenVector group1 = set1.groupNen + link2->nen;
+                loser = makeLink(rIdx1, link2->fights - link1->fights, group1);
+                set1.groupNen = group1 + set2.groupNen;
+                set1.lastChrono.store(set2.lastChrono.load(memory_order_relaxed), memory_order_release);
+                set1.size.store(size1 + size2, memory_order_release);
+                set1.experience.fetch_add(set2.experience.load(memory_order_relaxed), memory_order_acq_rel);
+                publish(rIdx2, loser);
+            }
+            else {
+                //called from force_join
+                if (order == 1) {
+                    NenVector nen2 = link2->nen + link1->nen + set1.groupNen;
+                    winner = makeLink(rIdx2, link2->fights, nen2);
+                    loser = makeLink(rIdx2, link1->fights - link2->fights, link1->nen - nen2);
+                }
+                else {
+                    loser = makeLink(rIdx2, link1->fights - link2->fights, set1.groupNen);
+                    set2.groupNen += link2->nen;
+                    set1.groupNen += set2.groupNen;
+                    set2.lastChrono.store(set1.lastChrono.load(memory_order_relaxed), memory_order_release);
+                }
+                set2.size.store(size1 + size2, memory_order_release);
+                set2.experience.fetch_add(set1.experience.load(memory_order_relaxed), memory_order_acq_rel);
+                if (winner) publish(rIdx2, winner);
+                publish(rIdx1, loser);
+            }
+        }
+        catch (...) {
+            if (winner) retire(winner);
+            unlock(rIdx2);
+            unlock(rIdx1);
+            throw;
+        }
+        unlock(rIdx2);
+        unlock(rIdx1);
+    }
+
+    int count() const {
+        return nextIdx.load(memory_order_acquire);
+    }
+
+    int retiredRecords() const {
+        return retiredCount.load(memory_order_acquire);
+    }
+
+    // hand the retired records to the free list for reuse. only while no
+    // other thread uses the union
+    void reclaim() {
+        CLink* link = retired.exchange(nullptr, memory_order_acquire);
+        retiredCount.store(0, memory_order_relaxed);
+        while (link) {
+            CLink* next = link->next.load(memory_order_relaxed);
+            link->next.store(freeList.load(memory_order_relaxed), memory_order_relaxed);
+            freeList.store(link, memory_order_release);
+            link = next;
+        }
+    }
+};
+
+#endif //CONCURRENTUNION_H
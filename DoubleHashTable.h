@@ -6,21 +6,22 @@
 #define DOUBLEHASHTABLE_H
 #define  LOAD_FACTOR 0.7
 #include <exception>
+#include <cstddef>
+#include <cstring>
+#include "wet2util.h"
+#include "Snapshot.h"
+#include "Prefetch.h"
 
 enum SlotStatus { EMPTY, OCCUPIED, DELETED };
 
 template <typename K, typename V>
 class DoubleHashTable {
 private:
-    struct Entry {
-        K key;
-        V value;
-        SlotStatus status;
-
-        Entry() : status(EMPTY) {}
-    };
-
-    Entry* table;
+    // the slots are kept as three parallel arrays: a probe only reads the
+    // one byte status and the key, the value is touched once the key matched
+    unsigned char* status;
+    K* keys;
+    V* values;
     int capacity;// always prime
     int size;
 
@@ -29,30 +30,63 @@ private:
     DoubleHashTable& operator=(const DoubleHashTable&) = delete;
 
     DoubleHashTable(DoubleHashTable&& other) noexcept
-      : table(other.table), capacity(other.capacity), size(other.size) {
-        other.table = nullptr;
+      : status(other.status), keys(other.keys), values(other.values),
+        capacity(other.capacity), size(other.size) {
+        other.status = nullptr;
+        other.keys = nullptr;
+        other.values = nullptr;
         other.capacity = 0;
         other.size = 0;
     }
 
     DoubleHashTable& operator=(DoubleHashTable&& other) noexcept {
         if (this == &other) return *this;
-        delete[] table;
-        table = other.table;
+        release();
+        status = other.status;
+        keys = other.keys;
+        values = other.values;
         capacity = other.capacity;
         size = other.size;
-        other.table = nullptr;
+        other.status = nullptr;
+        other.keys = nullptr;
+        other.values = nullptr;
         other.capacity = 0;
         other.size = 0;
         return *this;
     }
 
+    // allocate empty arrays of the current capacity
+    void allocate() {
+        unsigned char* newStatus = new unsigned char[capacity];
+        K* newKeys = nullptr;
+        V* newValues = nullptr;
+        try {
+            newKeys = new K[capacity];
+            newValues = new V[capacity];
+        }
+        catch (...) {
+            delete[] newKeys;
+            delete[] newStatus;
+            throw;
+        }
+        status = newStatus;
+        keys = newKeys;
+        values = newValues;
+        for (int i = 0; i < capacity; i++) status[i] = EMPTY;
+    }
+
+    void release() {
+        delete[] status;
+        delete[] keys;
+        delete[] values;
+    }
+
 
     bool isPrime(int n) const {
         if (n <= 1) return false;
         if (n % 2 == 0 ) return false;
         // for each number between 2 and then every odd check if devides n
-        for (int i = 3; i * i <= n; i += 2) {
+        for (int i = 3; (long long)i * i <= n; i += 2) {
             if (n % i == 0 || n % (i + 2) == 0) return false;
         }
         return true;
@@ -83,102 +117,235 @@ private:
         return step;
     }
 
-    // create a new array (~size(capacity * 2)) and move items there
-    void rehash() {
+    // next slot of a probe sequence, (index + i * step) % capacity
+    // without overflowing once i * step passes INT_MAX
+    int advance(int current, int step) const {
+        current += step;
+        if (current >= capacity) current -= capacity;
+        return current;
+    }
+
+    // return the slot holding key, -1 if it is missing
+    int locate(const K& key) const {
+        int current = h1(key);
+        int step = h2(key);
+
+        for (int i = 0; i < capacity; i++) {
+            if (status[current] == EMPTY) return -1;
+            if (status[current] == OCCUPIED && keys[current] == key) return current;
+            current = advance(current, step);
+        }
+        return -1;
+    }
+
+    // create new arrays of newCapacity slots and move items there
+    void rebuild(int newCapacity) {
         int oldCapacity = capacity;
-        Entry* oldTable = table;
+        unsigned char* oldStatus = status;
+        K* oldKeys = keys;
+        V* oldValues = values;
 
-        capacity = nextPrime(capacity * 2);
-        table = new Entry[capacity];
+        capacity = newCapacity;
+        try {
+            allocate();
+        }
+        catch (...) {
+            capacity = oldCapacity;
+            status = oldStatus;
+            keys = oldKeys;
+            values = oldValues;
+            throw;
+        }
         size = 0;
 
         for (int i = 0; i < oldCapacity; i++) {
-            if (oldTable[i].status == OCCUPIED) {
-                insert(oldTable[i].key, oldTable[i].value);
+            if (oldStatus[i] == OCCUPIED) {
+                insert(oldKeys[i], oldValues[i]);
             }
         }
-        delete[] oldTable;
+        delete[] oldStatus;
+        delete[] oldKeys;
+        delete[] oldValues;
+    }
+
+    // create a new array (~size(capacity * 2)) and move items there
+    void rehash() {
+        rebuild(nextPrime(capacity * 2));
     }
 
 public:
-    DoubleHashTable(int initCapacity = 11) : capacity(initCapacity), size(0) {
-        table = new Entry[capacity];
+    // the capacity is rounded up to a prime
+    DoubleHashTable(int initCapacity = 11) : status(nullptr), keys(nullptr), values(nullptr),
+                                             capacity(initCapacity), size(0) {
+        if (!isPrime(capacity)) capacity = nextPrime(capacity);
+        allocate();
     }
 
     ~DoubleHashTable() {
-        delete[] table;
+        release();
     }
 
 
     void insert(const K& key, const V& value) {
+        bool inserted = false;
+        try_emplace(key, inserted) = value;
+    }
+
+    // find the slot of key, claiming a free one if the key is missing.
+    // inserted tells whether the slot is new; a new slot holds V() until
+    // the caller writes it. the reference is valid until the next insertion
+    V& try_emplace(const K& key, bool& inserted) {
         // check if load factor passed, if yes than rehash
         if ((double)size / capacity >= LOAD_FACTOR) {
             rehash();
         }
 
-        int index = h1(key);
+        int current = h1(key);
         int step = h2(key);
         int firstDeleted = -1;
+        int target = -1;
 
         // find the next EMPTY spot
         for (int i = 0; i < capacity; i++) {
-            // the index to check
-            int current = (index + i * step) % capacity;
-
-            if (table[current].status == EMPTY) {
+            if (status[current] == EMPTY) {
                 // if available first deleted insert there
-                int targetIndex = (firstDeleted != -1) ? firstDeleted : current;
-                table[targetIndex].key = key;
-                table[targetIndex].value = value;
-                table[targetIndex].status = OCCUPIED;
-                size++;
-                return;
+                target = (firstDeleted != -1) ? firstDeleted : current;
+                break;
             }
 
-            if (table[current].status == OCCUPIED && table[current].key == key) {
-                // update value if exist
-                table[current].value = value;
-                return;
+            if (status[current] == OCCUPIED && keys[current] == key) {
+                inserted = false;
+                return values[current];
             }
 
-            if (table[current].status == DELETED && firstDeleted == -1) {
+            if (status[current] == DELETED && firstDeleted == -1) {
                 // save first Deleted index for later insertion
                 firstDeleted = current;
             }
+            current = advance(current, step);
         }
+        // a full sweep without EMPTY slots can still reuse a deleted one
+        if (target == -1) target = firstDeleted;
+
+        keys[target] = key;
+        values[target] = V();
+        status[target] = OCCUPIED;
+        size++;
+        inserted = true;
+        return values[target];
     }
 
-    // return a pointer to the relevant slot if available, nullptr o.w
-    V find(const K& key) {
-        int index = h1(key);
-        int step = h2(key);
+    // grow once so that count keys fit under the load factor, the inserts
+    // up to count then never rehash. at least doubles like rehash, so
+    // reserving a little at a time stays amortized. nothing changes if it throws
+    void reserve(int count) {
+        int needed = (int)(count / LOAD_FACTOR) + 1;
+        if (needed <= capacity) return;
+        rebuild(nextPrime(needed > capacity * 2 ? needed : capacity * 2));
+    }
 
-        for (int i = 0; i < capacity; i++) {
-            int current = (index + i * step) % capacity;
+    // the stored value of key to overwrite in place, nullptr if it is
+    // missing. never rehashes, so it cannot throw
+    V* lookup(const K& key) {
+        int current = locate(key);
+        if (current == -1) return nullptr;
+        return &values[current];
+    }
+
+    // return the value stored for key, -1 if it is missing
+    V find(const K& key) const {
+        int current = locate(key);
+        if (current == -1) return -1;
+        return values[current];
+    }
 
-            if (table[current].status == EMPTY) return -1;
-            if (table[current].status == OCCUPIED && table[current].key == key) {
-                return (table[current].value);
+    // out[i] = find(queries[i]) for every i < n. the keys go in groups: all home
+    // slots of a group are prefetched first, then the probes run while the
+    // matched values are prefetched, then the values are read - so the cache
+    // misses of one group overlap instead of being paid one after the other
+    void find_batch(const K* queries, V* out, size_t n) const {
+        int slots[BATCH_GROUP];
+        for (size_t start = 0; start < n; start += BATCH_GROUP) {
+            int group = (n - start < BATCH_GROUP) ? (int)(n - start) : BATCH_GROUP;
+
+            for (int i = 0; i < group; i++) {
+                int home = h1(queries[start + i]);
+                HASH_PREFETCH(status + home);
+                HASH_PREFETCH(keys + home);
+            }
+            for (int i = 0; i < group; i++) {
+                slots[i] = locate(queries[start + i]);
+                if (slots[i] != -1) HASH_PREFETCH(values + slots[i]);
+            }
+            for (int i = 0; i < group; i++) {
+                out[start + i] = (slots[i] == -1) ? -1 : values[slots[i]];
             }
         }
-        return -1;
+    }
+
+    // visit(key, value) for every entry, in slot order
+    template <class F>
+    void for_each(F visit) const {
+        for (int i = 0; i < capacity; i++) {
+            if (status[i] == OCCUPIED) visit(keys[i], values[i]);
+        }
+    }
+
+    // the three slot arrays as they are, K and V trivially copyable. load
+    // replaces the table, throws FAILURE on a short or inconsistent stream
+    // and then leaves the table as it was
+    void save(SnapshotWriter& out) const {
+        out.writeInt(capacity);
+        out.writeInt(size);
+        out.write(status, capacity);
+        out.write(keys, sizeof(K) * capacity);
+        out.write(values, sizeof(V) * capacity);
+    }
+
+    void load(SnapshotReader& in) {
+        int newCapacity = in.readInt();
+        int newSize = in.readInt();
+        if (newCapacity < 0 || (1 + sizeof(K) + sizeof(V)) * (size_t)newCapacity > in.remaining())
+            throw StatusType::FAILURE;
+        // a probe covers the whole table only when the capacity is prime
+        if (!isPrime(newCapacity) || newSize < 0 || newSize > newCapacity) throw StatusType::FAILURE;
+        const unsigned char* newStatus = static_cast<const unsigned char*>(in.read(newCapacity));
+        // the load factor is kept by size, it must match the slots
+        int occupied = 0;
+        for (int i = 0; i < newCapacity; i++) {
+            if (newStatus[i] > DELETED) throw StatusType::FAILURE;
+            if (newStatus[i] == OCCUPIED) occupied++;
+        }
+        if (occupied != newSize) throw StatusType::FAILURE;
+        const void* newKeys = in.read(sizeof(K) * (size_t)newCapacity);
+        const void* newValues = in.read(sizeof(V) * (size_t)newCapacity);
+        DoubleHashTable table(newCapacity);
+        memcpy(table.status, newStatus, newCapacity);
+        memcpy(table.keys, newKeys, sizeof(K) * newCapacity);
+        memcpy(table.values, newValues, sizeof(V) * newCapacity);
+        table.size = newSize;
+        // every key must be the first one its own probe meets, or find
+        // misses it or finds a copy of it first
+        for (int i = 0; i < newCapacity; i++) {
+            if (table.status[i] == OCCUPIED && table.locate(table.keys[i]) != i) throw StatusType::FAILURE;
+        }
+        *this = std::move(table);
     }
 
     // according to a certain key mark a slot as deleted
     void remove(const K& key) {
-        int index = h1(key);
+        int current = h1(key);
         int step = h2(key);
 
         for (int i = 0; i < capacity; i++) {
-            int current = (index + i * step) % capacity;
-
-            if (table[current].status == EMPTY) return;
-            if (table[current].status == OCCUPIED && table[current].key == key)
+            if (status[current] == EMPTY) return;
+            if (status[current] == OCCUPIED && keys[current] == key)
                 {
-                    table[current].status = DELETED;
+                    status[current] = DELETED;
                     size--;
                     return;
                 }
+            current = advance(current, step);
         }
     }
 };
@@ -2,62 +2,170 @@
 #define DYNAMICARRAY_H
 #include <stdexcept>
 #include <memory>
+#include <new>
+#include <cstring>
+#define FIRST_CHUNK_BITS 4
+#define FIRST_CHUNK (1 << FIRST_CHUNK_BITS)
+#define CHUNK_DIRECTORY (31 - FIRST_CHUNK_BITS)
 using namespace std;
 
-template <class T>
-struct ANode {
-    unique_ptr<T> value;
-    int parent;
-    int size;
-    int experience;
-    int lastChrono;
-    NenAbility selfNen;
-    NenAbility groupNen;
-    ANode() : value(nullptr) , parent(-1) ,size(0) ,experience(0) , lastChrono(0){}
-};
-
+// storage is a fixed directory of chunks, chunk k holds FIRST_CHUNK << k
+// elements. growing only allocates the next chunk: nothing is copied and an
+// element never moves once it was pushed. chunks are raw memory and an element
+// is constructed by push_back, so a new chunk costs an allocation and nothing more
 template <class T>
 class DynamicArray {
-    unique_ptr<ANode<T>[]> head;
+    T* chunks[CHUNK_DIRECTORY];
     int size;
     int capacity;
+    int chunkCount;
     void reserve();
+    T& at(int i);
+    const T& at(int i) const;
+    static int highestBit(unsigned int n);
+    DynamicArray(const DynamicArray&) = delete;
+    DynamicArray& operator=(const DynamicArray&) = delete;
 public:
-    DynamicArray(): head(make_unique<ANode<T>[]>(1)),size(0),capacity(1){}
-    ANode<T>& operator[](int i);
+    DynamicArray(): chunks(),size(0),capacity(0),chunkCount(0){}
+    ~DynamicArray();
+    T& operator[](int i);
+    const T& operator[](int i) const;
     int push_back(T newPtr);
+    void pop_back();
+    // room for extra more elements, so the next extra push_backs never
+    // allocate. the chunks it got stay if it throws
+    void reserve(int extra);
+    int getSize() const;
+    void swap(DynamicArray& other);
+    // the elements as runs of adjacent memory, visit(const T* run, int count)
+    // for each in order
+    template <class F>
+    void for_each_run(F visit) const;
+    // push n elements copied byte for byte, for a trivially copyable T.
+    // data needs no alignment, it is only read through memcpy. nothing is
+    // added if it throws
+    void append(const void* data, int n);
 };
+
+// index of the highest set bit, n > 0
 template <class T>
-void DynamicArray<T>::reserve() {
-    auto temp =  make_unique<ANode<T>[]>(capacity*2); // to not change capacity if storge fail
-    capacity = capacity * 2 ;
-    for(int i = 0; i < size ;i++) {
-        temp[i].value = move(head[i].value);
-        temp[i].parent = head[i].parent;
-        temp[i].size = head[i].size;
-        temp[i].experience = head[i].experience;
-        temp[i].selfNen = head[i].selfNen;
-        temp[i].groupNen = head[i].groupNen;
-        temp[i].lastChrono = head[i].lastChrono;
+int DynamicArray<T>::highestBit(unsigned int n) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - __builtin_clz(n);
+#else
+    int bit = 0;
+    while (n >>= 1) bit++;
+    return bit;
+#endif
+}
+
+template <class T>
+DynamicArray<T>::~DynamicArray() {
+    for(int i = 0; i < size; i++) {
+        at(i).~T();
+    }
+    for(int k = 0; k < chunkCount; k++) {
+        ::operator delete(chunks[k]);
     }
-    head = std::move(temp);
 }
 
 template <class T>
-ANode<T>& DynamicArray<T>::operator[](int i) {
-    if(i < size) return head[i];
-    throw out_of_range("DynamicArray index out of range");;
+void DynamicArray<T>::reserve() {
+    if(chunkCount == CHUNK_DIRECTORY) throw bad_alloc();
+    int chunkSize = FIRST_CHUNK << chunkCount;
+    chunks[chunkCount] = static_cast<T*>(::operator new(sizeof(T) * chunkSize)); // to not change capacity if storge fail
+    chunkCount++;
+    capacity += chunkSize;
+}
+
+// i + FIRST_CHUNK has its highest bit at log2(FIRST_CHUNK) + chunk number,
+// the remaining bits are the offset inside that chunk
+template <class T>
+T& DynamicArray<T>::at(int i) {
+    unsigned int j = (unsigned int)i + FIRST_CHUNK;
+    int bit = highestBit(j);
+    return chunks[bit - FIRST_CHUNK_BITS][j - (1u << bit)];
+}
+
+template <class T>
+const T& DynamicArray<T>::at(int i) const {
+    unsigned int j = (unsigned int)i + FIRST_CHUNK;
+    int bit = highestBit(j);
+    return chunks[bit - FIRST_CHUNK_BITS][j - (1u << bit)];
+}
+
+template <class T>
+T& DynamicArray<T>::operator[](int i) {
+    if(i < 0 || i >= size) throw out_of_range("DynamicArray index out of range");
+    return at(i);
+}
+template <class T>
+const T& DynamicArray<T>::operator[](int i) const {
+    if(i < 0 || i >= size) throw out_of_range("DynamicArray index out of range");
+    return at(i);
 }
 template <class T>
 int DynamicArray<T>::push_back(T newPtr) {
-    unique_ptr<T> uPtr = make_unique<T>(move(newPtr));
     if(size == capacity) {
         reserve();
     }
-    head[size].value = move(uPtr);
-    head[size].parent = size;
-    head[size].size = 1;
+    new (&at(size)) T(move(newPtr));
     size++;
     return size-1;
 }
+template <class T>
+void DynamicArray<T>::reserve(int extra) {
+    while(capacity - size < extra) {
+        reserve();
+    }
+}
+template <class T>
+void DynamicArray<T>::pop_back() {
+    if(size == 0) throw out_of_range("DynamicArray is empty");
+    size--;
+    at(size).~T();
+}
+template <class T>
+int DynamicArray<T>::getSize() const {
+    return size;
+}
+// exchange the contents of two arrays, no element is touched
+template <class T>
+void DynamicArray<T>::swap(DynamicArray& other) {
+    for(int k = 0; k < CHUNK_DIRECTORY; k++) {
+        T* temp = chunks[k];
+        chunks[k] = other.chunks[k];
+        other.chunks[k] = temp;
+    }
+    int temp = size; size = other.size; other.size = temp;
+    temp = capacity; capacity = other.capacity; other.capacity = temp;
+    temp = chunkCount; chunkCount = other.chunkCount; other.chunkCount = temp;
+}
+template <class T>
+template <class F>
+void DynamicArray<T>::for_each_run(F visit) const {
+    int done = 0;
+    for(int k = 0; done < size; k++) {
+        int count = FIRST_CHUNK << k;
+        if(count > size - done) count = size - done;
+        visit(chunks[k], count);
+        done += count;
+    }
+}
+template <class T>
+void DynamicArray<T>::append(const void* data, int n) {
+    const char* bytes = static_cast<const char*>(data);
+    reserve(n);
+    while(n > 0) {
+        // room left in the chunk holding index size
+        unsigned int j = (unsigned int)size + FIRST_CHUNK;
+        int bit = highestBit(j);
+        int count = (int)((1u << bit) - (j - (1u << bit)));
+        if(count > n) count = n;
+        memcpy(static_cast<void*>(&at(size)), bytes, sizeof(T) * count);
+        size += count;
+        bytes += sizeof(T) * count;
+        n -= count;
+    }
+}
 #endif //DYNAMICARRAY_H
@@ -1,22 +1,43 @@
 #include "Huntech26a2.h"
+#include <cstring>
+#include <type_traits>
+#include "Roster.h"
+#include "Snapshot.h"
+#include "Prefetch.h"
 
-Huntech::Huntech() = default;
+Huntech::Huntech() : lsn(0) {}
 Huntech::~Huntech() = default;
 
+// the squad with this id, throws FAILURE if there is none
+Squad& Huntech::find_squad(int squadId) {
+    int slot = squads.find(squadId);
+    if(slot == -1) throw StatusType::FAILURE;
+    return squads[slot];
+}
+
+const Squad& Huntech::find_squad(int squadId) const {
+    int slot = squads.find(squadId);
+    if(slot == -1) throw StatusType::FAILURE;
+    return squads[slot];
+}
+
+bool Huntech::log_broken() const {
+    return wal && !wal->healthy();
+}
+
+bool Huntech::logged(int op, int arg0, int arg1, int arg2, int arg3, const NenVector* nen) {
+    lsn++;
+    if(!wal) return true;
+    int args[4] = {arg0, arg1, arg2, arg3};
+    return wal->append(op, args, nen);
+}
+
 StatusType Huntech::add_squad(int squadId) {
     if(squadId <= 0) return StatusType::INVALID_INPUT;
+    if(log_broken()) return StatusType::FAILURE;
     try {
-        squadsTree.insert(squadId, make_unique<Squad>(squadId));
-        try {
-            AuraKey key(0, squadId);
-            squadsAuraTree.insert(key, &squadsTree.search(squadId));
-        }
-        // make sure to rollback if second insertion fails
-        catch(...) {
-            squadsTree.del(squadId);
-            throw;
-        }
-
+        if(squads.find(squadId) != -1) return StatusType::FAILURE;
+        squads.insert(squadId);
     }
     catch(bad_alloc&) {
         return StatusType::ALLOCATION_ERROR;
@@ -24,23 +45,23 @@ StatusType Huntech::add_squad(int squadId) {
     catch(StatusType e) {
         return e;
     }
+    if(!logged(WAL_ADD_SQUAD, squadId)) return StatusType::FAILURE;
     return StatusType::SUCCESS;
 }
 
 StatusType Huntech::remove_squad(int squadId) {
     if(squadId <= 0) return StatusType::INVALID_INPUT;
+    if(log_broken()) return StatusType::FAILURE;
     try {
-        Squad& squad = squadsTree.search(squadId);
-
-        AuraKey key(squad.totalAura, squadId);
-        squadsAuraTree.del(key);
+        int slot = squads.find(squadId);
+        if(slot == -1) return StatusType::FAILURE;
 
-        int head = squad.getUnionHead();
+        int head = squads[slot].getUnionHead();
         if(head != -1) {
             huntersUnion.kill(head);
         }
 
-        squadsTree.del(squadId);
+        squads.remove(slot);
     }
     catch(bad_alloc&) {
         return StatusType::ALLOCATION_ERROR;
@@ -48,9 +69,33 @@ StatusType Huntech::remove_squad(int squadId) {
     catch(...) {
         return StatusType::FAILURE;
     }
+
+    int dead = huntersUnion.deadNodes();
+    if(dead >= COMPACT_MIN_DEAD && dead > huntersUnion.count() - dead) {
+        try {
+            compact_hunters();
+        }
+        // the squad is gone either way, the next removal tries again
+        catch(bad_alloc&) {}
+    }
+    if(!logged(WAL_REMOVE_SQUAD, squadId)) return StatusType::FAILURE;
     return StatusType::SUCCESS;
 }
 
+// drop the hunters of removed squads from the union. their ids stay taken and
+// keep answering get_hunter_fights_number through a retired index value
+void Huntech::compact_hunters() {
+    unique_ptr<int[]> remap = huntersUnion.compact(RETIRED_MAX_FIGHTS, [this](const Hunter& hunter, int newIdx, int fights) {
+        int* slot = huntersIndex.lookup(hunter.getId());
+        if(slot) *slot = (newIdx == -1) ? RETIRED_HUNTER - fights : newIdx;
+    });
+    // free slots hold Squad(0), whose head is -1
+    for(int i = 0; i < squads.slots(); i++) {
+        int head = squads[i].getUnionHead();
+        if(head != -1) squads[i].setUnionHead(remap[head]);
+    }
+}
+
 StatusType Huntech::add_hunter(int hunterId,
                                int squadId,
                                const NenAbility &nenType,
@@ -59,50 +104,105 @@ StatusType Huntech::add_hunter(int hunterId,
 {
     // FIX: aura < 0 must be INVALID_INPUT (per wet2 spec)
     if(squadId <= 0 || hunterId <= 0 || !nenType.isValid() || aura < 0 || fightsHad < 0) return StatusType::INVALID_INPUT;
+    if(log_broken()) return StatusType::FAILURE;
+    return insert_hunter(hunterId, squadId, NenVector::fromAbility(nenType), aura, fightsHad);
+}
+
+// add_hunter past its checks, with the ability as a NenVector. the log
+// replays through here
+StatusType Huntech::insert_hunter(int hunterId, int squadId, const NenVector& nen,
+                                  int aura, int fightsHad) {
     try {
-        if(hashTable.find(hunterId) != -1) return StatusType::FAILURE;
-        Squad& squad = squadsTree.search(squadId);
+        int squadSlot = squads.find(squadId);
+        if(squadSlot == -1) return StatusType::FAILURE;
+        Squad& squad = squads[squadSlot];
+
+        // one probe both rejects duplicates and reserves the slot for the new hunter
+        bool inserted = false;
+        int& slot = huntersIndex.try_emplace(hunterId, inserted);
+        if(!inserted) return StatusType::FAILURE;
 
         int oldAura = squad.totalAura;
         int newAura = oldAura + aura;
-        int oldNen = squad.totalNenAbility;
 
-        AuraKey oldKey(oldAura, squadId);
-        AuraKey newKey(newAura, squadId);
-
-        squadsAuraTree.del(oldKey);
+        // repositioning in the aura order relinks hooks, it cannot fail
+        squads.setAura(squadSlot, newAura);
+        squad.totalNenAbility += nen;
 
         try {
-            squadsAuraTree.insert(newKey, &squad);
+            int newIdx = huntersUnion.makeSet(Hunter(hunterId, nen, aura, fightsHad));
+            slot = newIdx;
+            int uHeadIdx = squad.getUnionHead();
+            if(uHeadIdx == -1)
+                squad.setUnionHead(newIdx);
+            else {
+                huntersUnion.combine(uHeadIdx, newIdx, 0);
+            }
         }
         catch (...) {
             // rollback on failure
-            squadsAuraTree.insert(oldKey, &squad);
+            huntersIndex.remove(hunterId);
+            squads.setAura(squadSlot, oldAura);
+            squad.totalNenAbility -= nen;
             throw;
         }
 
-        squad.totalAura = newAura;
-        squad.totalNenAbility = oldNen;
+    }
+    catch(bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    catch(StatusType e) {
+        return e;
+    }
+    if(!logged(WAL_ADD_HUNTER, hunterId, squadId, aura, fightsHad, &nen)) return StatusType::FAILURE;
+    return StatusType::SUCCESS;
+}
 
+StatusType Huntech::add_hunters(int squadId, const HunterSpec* hunters, int n) {
+    if(squadId <= 0 || n < 0 || (n > 0 && !hunters)) return StatusType::INVALID_INPUT;
+    for(int i = 0; i < n; i++) {
+        const HunterSpec& hunter = hunters[i];
+        if(hunter.hunterId <= 0 || !hunter.nenType.isValid() || hunter.aura < 0 || hunter.fightsHad < 0)
+            return StatusType::INVALID_INPUT;
+    }
+    if(log_broken()) return StatusType::FAILURE;
+    try {
+        int squadSlot = squads.find(squadId);
+        if(squadSlot == -1) return StatusType::FAILURE;
+        Squad& squad = squads[squadSlot];
+
+        // claim every id before anything else changes, a taken one or one
+        // repeated in the batch gives back the ids claimed so far
+        int claimed = 0;
+        int addedAura = 0;
+        NenVector addedNen;
         try {
-            int newIdx = huntersUnion.makeSet(Hunter(hunterId, nenType, aura, fightsHad));
-            hashTable.insert(hunterId, newIdx);
-            int uHeadIdx = squad.getUnionHead();
-            if(uHeadIdx == -1)
-                squad.setUnionHead(newIdx);
-            else {
-                huntersUnion.combine(uHeadIdx, newIdx, 0);
+            huntersIndex.reserve(n);
+            int first = huntersUnion.count();
+            for(; claimed < n; claimed++) {
+                bool inserted = false;
+                int& slot = huntersIndex.try_emplace(hunters[claimed].hunterId, inserted);
+                if(!inserted) throw StatusType::FAILURE;
+                slot = first + claimed;
             }
+            huntersUnion.appendRun(squad.getUnionHead(), n, [&](int i) {
+                const HunterSpec& hunter = hunters[i];
+                NenVector nen = NenVector::fromAbility(hunter.nenType);
+                addedAura += hunter.aura;
+                addedNen += nen;
+                return Hunter(hunter.hunterId, nen, hunter.aura, hunter.fightsHad);
+            });
+            if(n > 0 && squad.getUnionHead() == -1) squad.setUnionHead(first);
         }
         catch (...) {
             // rollback on failure
-            squadsAuraTree.del(newKey);
-            squadsAuraTree.insert(oldKey, &squad);
-            squad.totalAura = oldAura;
-            squad.totalNenAbility = oldNen;
+            for(int i = 0; i < claimed; i++) huntersIndex.remove(hunters[i].hunterId);
             throw;
         }
 
+        // the squad moves in the aura order once for the whole batch
+        squads.setAura(squadSlot, squad.totalAura + addedAura);
+        squad.totalNenAbility += addedNen;
     }
     catch(bad_alloc&) {
         return StatusType::ALLOCATION_ERROR;
@@ -110,60 +210,333 @@ StatusType Huntech::add_hunter(int hunterId,
     catch(StatusType e) {
         return e;
     }
+    // logged as the add_hunter calls it stands for, the first record the
+    // log cannot take ends the batch
+    if(!wal) lsn += n;
+    for(int i = 0; wal && i < n; i++) {
+        const HunterSpec& hunter = hunters[i];
+        NenVector nen = NenVector::fromAbility(hunter.nenType);
+        if(!logged(WAL_ADD_HUNTER, hunter.hunterId, squadId, hunter.aura, hunter.fightsHad, &nen))
+            return StatusType::FAILURE;
+    }
     return StatusType::SUCCESS;
 }
 
-output_t<int> Huntech::squad_duel(int squadId1, int squadId2) {
-    if (squadId1 <= 0 || squadId2 <= 0 || squadId1 == squadId2)
-        return output_t<int>(StatusType::INVALID_INPUT);
+StatusType Huntech::bulk_load(const char* path) {
+    if(!path) return StatusType::INVALID_INPUT;
+    // a load is not a command the log can replay
+    // removed squads leave slots behind and retired hunters keep their ids,
+    // the build would write over both
+    if(wal || squads.slots() != 0 || huntersIndex.count() != 0) return StatusType::FAILURE;
+    try {
+        Roster roster;
+        StatusType status = roster.read(path);
+        if(status != StatusType::SUCCESS) return status;
+        int squadCount = roster.squadCount;
+        int hunterCount = roster.hunterCount;
+
+        // everything that allocates comes first, only the index inserts can
+        // still fail and they are taken back
+        squads.reserve(squadCount);
+        huntersUnion.reserve(hunterCount);
+        huntersIndex.reserve(hunterCount);
+        unique_ptr<int[]> nodeOf(new int[hunterCount]);
+        for(int k = 0; k < hunterCount; k++) nodeOf[roster.bySquad[k]] = k;
+
+        // the union nodes go squad after squad, so a hunter's node is its
+        // place in bySquad. the index takes the ids in ascending order, which
+        // keeps dense ids in its flat array
+        int claimed = 0;
+        try {
+            for(; claimed < hunterCount; claimed++) {
+                int h = roster.huntersById[claimed];
+                huntersIndex.insert(roster.hunterIds[h], nodeOf[h]);
+            }
+        }
+        catch (...) {
+            // rollback on failure
+            for(int i = 0; i < claimed; i++) huntersIndex.remove(roster.hunterIds[roster.huntersById[i]]);
+            throw;
+        }
 
-    int effective_aura_1, effective_aura_2;
+        // the file columns are read in bySquad order, the ones of a later
+        // hunter are prefetched while this one is linked
+        for(int s = 0; s < squadCount; s++) {
+            int first = roster.squadFirst[s];
+            huntersUnion.appendRun(-1, roster.squadFirst[s + 1] - first, [&](int i) {
+                int h = roster.bySquad[first + i];
+                if(first + i + BATCH_GROUP < hunterCount) {
+                    int later = roster.bySquad[first + i + BATCH_GROUP];
+                    HASH_PREFETCH(&roster.hunterIds[later]);
+                    HASH_PREFETCH(&roster.hunterTypes[later]);
+                    HASH_PREFETCH(&roster.hunterAuras[later]);
+                    HASH_PREFETCH(&roster.hunterFights[later]);
+                }
+                NenVector nen;
+                nen.lanes[roster.hunterTypes[h]] = 1;
+                return Hunter(roster.hunterIds[h], nen, roster.hunterAuras[h], roster.hunterFights[h]);
+            });
+        }
 
+        squads.build(roster.squadIds.get(), roster.squadAuras.get(), roster.squadsByAura.get(), squadCount);
+        for(int s = 0; s < squadCount; s++) {
+            Squad& squad = squads[s];
+            if(roster.squadFirst[s + 1] > roster.squadFirst[s]) squad.setUnionHead(roster.squadFirst[s]);
+            squad.totalNenAbility = roster.squadNen[s];
+        }
+        lsn += squadCount + hunterCount;
+    }
+    catch(bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    return StatusType::SUCCESS;
+}
+
+// the snapshot copies these as bytes
+static_assert(is_trivially_copyable<Hunter>::value, "Hunter is saved as bytes");
+static_assert(is_trivially_copyable<Squad>::value, "Squad is saved as bytes");
+static_assert(is_trivially_copyable<USet>::value, "USet is saved as bytes");
+
+// the build a snapshot was written by: record sizes must match for its
+// arrays to be read back as they are
+static const int SNAPSHOT_LAYOUT[] = {
+    (int)sizeof(int), (int)sizeof(ULink), (int)sizeof(USet), (int)sizeof(NenVector),
+    (int)sizeof(Hunter), (int)sizeof(Squad)
+};
+#define SNAPSHOT_LAYOUT_SIZE ((int)(sizeof(SNAPSHOT_LAYOUT) / sizeof(SNAPSHOT_LAYOUT[0])))
+
+StatusType Huntech::save_snapshot(const char* path) const {
+    if(!path) return StatusType::INVALID_INPUT;
+    if(wal && wal->sync() != StatusType::SUCCESS) return StatusType::FAILURE;
     try {
-        Squad& squad1 = squadsTree.search(squadId1);
-        Squad& squad2 = squadsTree.search(squadId2);
+        SnapshotWriter out(path);
+        if(!out.isOpen()) return StatusType::FAILURE;
+        out.write(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+        out.writeInt(SNAPSHOT_VERSION);
+        out.writeInt(SNAPSHOT_BYTE_ORDER);
+        out.writeInt(SNAPSHOT_LAYOUT_SIZE);
+        for(int i = 0; i < SNAPSHOT_LAYOUT_SIZE; i++) out.writeInt(SNAPSHOT_LAYOUT[i]);
+        out.write(&lsn, sizeof(lsn));
+        huntersIndex.save(out);
+        huntersUnion.save(out);
+        squads.save(out);
+        out.writeChecksum();
+        if(!out.commit()) return StatusType::FAILURE;
+    }
+    catch(bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    return StatusType::SUCCESS;
+}
 
-        int root_1 = squad1.getUnionHead();
-        int root_2 = squad2.getUnionHead();
+StatusType Huntech::load_snapshot(const char* path) {
+    if(!path) return StatusType::INVALID_INPUT;
+    // the log would go on from the wrong lsn
+    if(wal) return StatusType::FAILURE;
+    try {
+        SnapshotReader in(path);
+        if(!in.isOpen()) return StatusType::FAILURE;
+        if(memcmp(in.read(SNAPSHOT_MAGIC_SIZE), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0)
+            return StatusType::FAILURE;
+        int version = in.readInt();
+        if(version != SNAPSHOT_VERSION && version != SNAPSHOT_VERSION_NO_CHECKSUM &&
+           version != SNAPSHOT_VERSION_NO_LSN) return StatusType::FAILURE;
+        if(version == SNAPSHOT_VERSION && !in.verifyChecksum()) return StatusType::FAILURE;
+        if(in.readInt() != SNAPSHOT_BYTE_ORDER || in.readInt() != SNAPSHOT_LAYOUT_SIZE)
+            return StatusType::FAILURE;
+        for(int i = 0; i < SNAPSHOT_LAYOUT_SIZE; i++) {
+            if(in.readInt() != SNAPSHOT_LAYOUT[i]) return StatusType::FAILURE;
+        }
+        long long loadedLsn = 0;
+        if(version != SNAPSHOT_VERSION_NO_LSN) memcpy(&loadedLsn, in.read(sizeof(loadedLsn)), sizeof(loadedLsn));
+
+        // read into fresh structures, swapped in once the whole file is read
+        AdaptiveIdIndex<int, int> index;
+        Union<Hunter> hunters;
+        SquadPool pool;
+        index.load(in);
+        hunters.load(in);
+        pool.load(in);
+        if(!in.atEnd()) return StatusType::FAILURE;
+        // each part only checked its own links, the ones between them are
+        // checked here: hunters point at union nodes, and a squad's head is
+        // the root of its set or -1, always -1 in a free slot
+        int nodes = hunters.count();
+        bool linked = loadedLsn >= 0;
+        index.for_each([&](int, int node) {
+            if(node >= nodes || (node < 0 && node > RETIRED_HUNTER)) linked = false;
+        });
+        for(int slot = 0; slot < pool.slots(); slot++) {
+            int head = pool[slot].getUnionHead();
+            if(head == -1) continue;
+            if(pool[slot].getId() == 0 || head < 0 || head >= nodes || hunters.find(head) != head) linked = false;
+        }
+        if(!linked) return StatusType::FAILURE;
+        huntersIndex.swap(index);
+        huntersUnion.swap(hunters);
+        squads.swap(pool);
+        lsn = loadedLsn;
+    }
+    catch(bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    catch(StatusType e) {
+        return e;
+    }
+    return StatusType::SUCCESS;
+}
 
-        if (root_1 == -1 || root_2 == -1)
-            return output_t<int>(StatusType::FAILURE);
+StatusType Huntech::open_log(const char* path, int groupSize, int windowMicros) {
+    if(!path || groupSize <= 0 || windowMicros < 0) return StatusType::INVALID_INPUT;
+    if(wal) return StatusType::FAILURE;
+    try {
+        unique_ptr<Wal> log(new Wal());
+        StatusType status = log->open(path, lsn, groupSize, windowMicros);
+        if(status != StatusType::SUCCESS) return status;
+        wal = std::move(log);
+    }
+    catch(bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    return StatusType::SUCCESS;
+}
 
-        huntersUnion.addFight(root_1, root_2);
-        int exp_1 = huntersUnion.get_exp(root_1);
-        int exp_2 = huntersUnion.get_exp(root_2);
+StatusType Huntech::sync_log() {
+    if(!wal) return StatusType::FAILURE;
+    return wal->sync();
+}
 
-        NenAbility ab_1 = huntersUnion.partialAbility(huntersUnion.lastChrono(root_1));
-        NenAbility ab_2 = huntersUnion.partialAbility(huntersUnion.lastChrono(root_2));
+StatusType Huntech::poll_log() {
+    if(!wal) return StatusType::FAILURE;
+    return wal->poll();
+}
 
-        int Aura_1 = squad1.totalAura;
-        int Aura_2 = squad2.totalAura;
+StatusType Huntech::close_log() {
+    if(!wal) return StatusType::FAILURE;
+    StatusType status = wal->sync();
+    wal.reset();
+    return status;
+}
+
+long long Huntech::last_lsn() const {
+    return lsn;
+}
 
-        effective_aura_1 = exp_1 + Aura_1;
-        effective_aura_2 = exp_2 + Aura_2;
+long long Huntech::durable_lsn() const {
+    return wal ? wal->durableLsn() : 0;
+}
 
-        if(effective_aura_1 > effective_aura_2) {
-            huntersUnion.add_exp(root_1, 3);
-            return output_t<int>(1);
+StatusType Huntech::replay(const WalRecord& record) {
+    const int* args = record.args;
+    switch(record.op) {
+        case WAL_ADD_SQUAD:
+            return add_squad(args[0]);
+        case WAL_REMOVE_SQUAD:
+            return remove_squad(args[0]);
+        case WAL_ADD_HUNTER:
+            // checked as add_hunter would
+            if(args[0] <= 0 || args[1] <= 0 || args[2] < 0 || args[3] < 0) return StatusType::INVALID_INPUT;
+            for(int j = 0; j < NEN_TYPES; j++) {
+                if(record.nen.lanes[j] < 0) return StatusType::INVALID_INPUT;
+            }
+            return insert_hunter(args[0], args[1], record.nen, args[2], args[3]);
+        case WAL_SQUAD_DUEL:
+            return squad_duel(args[0], args[1]).status();
+        case WAL_FORCE_JOIN:
+            return force_join(args[0], args[1]);
+        default:
+            return StatusType::FAILURE;
+    }
+}
+
+StatusType Huntech::recover(const char* snapshotPath, const char* logPath) {
+    if(!logPath) return StatusType::INVALID_INPUT;
+    if(wal) return StatusType::FAILURE;
+    try {
+        // rebuilt aside, swapped in once every record applied
+        Huntech fresh;
+        if(snapshotPath) {
+            StatusType status = fresh.load_snapshot(snapshotPath);
+            if(status != StatusType::SUCCESS) return status;
         }
-        if(effective_aura_2 > effective_aura_1) {
-            huntersUnion.add_exp(root_2, 3);
-            return output_t<int>(3);
+        WalReader log(logPath);
+        if(log.isOpen()) {
+            if(!log.isValid() || log.firstLsn() > fresh.lsn + 1) return StatusType::FAILURE;
+            long long recordLsn = log.firstLsn() - 1;
+            WalRecord record;
+            while(log.next(record)) {
+                if(++recordLsn <= fresh.lsn) continue;
+                if(fresh.replay(record) != StatusType::SUCCESS) return StatusType::FAILURE;
+            }
         }
+        huntersIndex.swap(fresh.huntersIndex);
+        huntersUnion.swap(fresh.huntersUnion);
+        squads.swap(fresh.squads);
+        lsn = fresh.lsn;
+    }
+    catch(bad_alloc&) {
+        return StatusType::ALLOCATION_ERROR;
+    }
+    return StatusType::SUCCESS;
+}
 
-        if(ab_1 > ab_2) {
-            huntersUnion.add_exp(root_1, 3);
-            return output_t<int>(2);
-        }
+// one duel between two squads with hunters, given their resolved sets.
+// returns squad_duel's answer, never throws
+int Huntech::duel(const Squad& squad1, const Squad& squad2,
+                  const USummary& side_1, const USummary& side_2) {
+    int root_1 = side_1.root;
+    int root_2 = side_2.root;
 
-        if(ab_2 > ab_1) {
-            huntersUnion.add_exp(root_2, 3);
-            return output_t<int>(4);
-        }
+    huntersUnion.addFight(root_1, root_2);
+
+    int effective_aura_1 = side_1.experience + squad1.totalAura;
+    int effective_aura_2 = side_2.experience + squad2.totalAura;
+
+    if(effective_aura_1 > effective_aura_2) {
+        huntersUnion.add_exp(root_1, 3);
+        return 1;
+    }
+    if(effective_aura_2 > effective_aura_1) {
+        huntersUnion.add_exp(root_2, 3);
+        return 3;
+    }
+
+    // the squads keep their own Nen sums, no walk through the union.
+    // the matchup matrix is antisymmetric, one score decides both ways
+    int matchup = squad1.totalNenAbility.matchup(squad2.totalNenAbility);
+    if(matchup > 0) {
+        huntersUnion.add_exp(root_1, 3);
+        return 2;
+    }
+
+    if(matchup < 0) {
+        huntersUnion.add_exp(root_2, 3);
+        return 4;
+    }
+
+    huntersUnion.add_exp(root_1, 1);
+    huntersUnion.add_exp(root_2, 1);
+    return 0;
+}
+
+output_t<int> Huntech::squad_duel(int squadId1, int squadId2) {
+    if (squadId1 <= 0 || squadId2 <= 0 || squadId1 == squadId2)
+        return output_t<int>(StatusType::INVALID_INPUT);
+    if(log_broken()) return output_t<int>(StatusType::FAILURE);
 
-        huntersUnion.add_exp(root_1, 1);
-        huntersUnion.add_exp(root_2, 1);
-        return output_t<int>(0);
+    try {
+        Squad& squad1 = find_squad(squadId1);
+        Squad& squad2 = find_squad(squadId2);
+
+        int root_1 = squad1.getUnionHead();
+        int root_2 = squad2.getUnionHead();
+
+        if (root_1 == -1 || root_2 == -1)
+            return output_t<int>(StatusType::FAILURE);
+
+        int outcome = duel(squad1, squad2, huntersUnion.resolve(root_1), huntersUnion.resolve(root_2));
+        if(!logged(WAL_SQUAD_DUEL, squadId1, squadId2)) return output_t<int>(StatusType::FAILURE);
+        return output_t<int>(outcome);
     }
     catch(bad_alloc&) {
         return output_t<int>(StatusType::ALLOCATION_ERROR);
@@ -173,13 +546,70 @@ output_t<int> Huntech::squad_duel(int squadId1, int squadId2) {
     }
 }
 
-output_t<int> Huntech::get_hunter_fights_number(int hunterId) {
+StatusType Huntech::squad_duels(const int* squadIds1, const int* squadIds2, int n,
+                                int* outcomes, StatusType* results) {
+    if(n < 0 || (n > 0 && (!squadIds1 || !squadIds2 || !outcomes || !results)))
+        return StatusType::INVALID_INPUT;
+    if(log_broken()) return StatusType::FAILURE;
+    // a duel never adds, removes or joins squads, so whether a pair can fight
+    // and where its squads sit is known before any duel of the batch. the
+    // pairs go in groups: all squads of a group are checked and found and
+    // their records prefetched, then the group is fought in the given order.
+    // the pairs are not reordered by where their squads sit: a duel's answer
+    // depends on the experience the earlier duels of the batch handed out
+    int slots1[BATCH_GROUP];
+    int slots2[BATCH_GROUP];
+    for(int start = 0; start < n; start += BATCH_GROUP) {
+        int group = (n - start < BATCH_GROUP) ? n - start : BATCH_GROUP;
+        for(int i = 0; i < group; i++) {
+            int squadId1 = squadIds1[start + i];
+            int squadId2 = squadIds2[start + i];
+            slots1[i] = -1;
+            if(squadId1 <= 0 || squadId2 <= 0 || squadId1 == squadId2) {
+                results[start + i] = StatusType::INVALID_INPUT;
+                continue;
+            }
+            int slot1 = squads.find(squadId1);
+            int slot2 = squads.find(squadId2);
+            if(slot1 == -1 || slot2 == -1 || squads[slot1].getUnionHead() == -1 ||
+               squads[slot2].getUnionHead() == -1) {
+                results[start + i] = StatusType::FAILURE;
+                continue;
+            }
+            huntersUnion.prefetch(squads[slot1].getUnionHead());
+            huntersUnion.prefetch(squads[slot2].getUnionHead());
+            slots1[i] = slot1;
+            slots2[i] = slot2;
+            results[start + i] = StatusType::SUCCESS;
+        }
+        for(int i = 0; i < group; i++) {
+            if(slots1[i] == -1) continue;
+            const Squad& squad1 = squads[slots1[i]];
+            const Squad& squad2 = squads[slots2[i]];
+            outcomes[start + i] = duel(squad1, squad2, huntersUnion.resolve(squad1.getUnionHead()),
+                                       huntersUnion.resolve(squad2.getUnionHead()));
+            if(!logged(WAL_SQUAD_DUEL, squadIds1[start + i], squadIds2[start + i])) {
+                // the log broke: this duel went unlogged and the rest are not fought
+                for(int k = start + i; k < n; k++) results[k] = StatusType::FAILURE;
+                return StatusType::FAILURE;
+            }
+        }
+    }
+    return StatusType::SUCCESS;
+}
+
+// the queries below are written once for both paths: System is Huntech for
+// the compressing one and const Huntech for the read-only one, and the union
+// calls pick the overload of the same constness
+template <class System>
+output_t<int> Huntech::hunter_fights(System& system, int hunterId) {
     int fights = 0;
     if(hunterId <= 0) return output_t<int>(StatusType::INVALID_INPUT);
     try {
-        int uIdx = hashTable.find(hunterId);
+        int uIdx = system.huntersIndex.find(hunterId);
         if(uIdx == -1) return output_t<int>(StatusType::FAILURE);
-        fights = huntersUnion.fightsHad(uIdx);
+        if(uIdx <= RETIRED_HUNTER) fights = RETIRED_HUNTER - uIdx;
+        else fights = system.huntersUnion.fightsHad(uIdx);
     }
     catch(bad_alloc&) {
         return output_t<int>(StatusType::ALLOCATION_ERROR);
@@ -190,14 +620,15 @@ output_t<int> Huntech::get_hunter_fights_number(int hunterId) {
     return output_t<int>(fights);
 }
 
-output_t<int> Huntech::get_squad_experience(int squadId) {
+template <class System>
+output_t<int> Huntech::squad_experience(System& system, int squadId) {
     int exp = 0;
     if(squadId <= 0) return output_t<int>(StatusType::INVALID_INPUT);
     try {
-        Squad& squad = squadsTree.search(squadId);
+        const Squad& squad = system.find_squad(squadId);
         int head = squad.getUnionHead();
         if(head == -1) return output_t<int>(0);
-        exp = huntersUnion.get_exp(head);
+        exp = system.huntersUnion.get_exp(head);
     }
     catch(bad_alloc&) {
         return output_t<int>(StatusType::ALLOCATION_ERROR);
@@ -208,36 +639,89 @@ output_t<int> Huntech::get_squad_experience(int squadId) {
     return output_t<int>(exp);
 }
 
-output_t<int> Huntech::get_ith_collective_aura_squad(int i) {
-    if(i < 0) return output_t<int>(StatusType::FAILURE);
+template <class System>
+output_t<NenAbility> Huntech::partial_nen_ability(System& system, int hunterId) {
+    NenAbility ability;
+    if(hunterId <= 0) return output_t<NenAbility>(StatusType::INVALID_INPUT);
     try {
-        AuraKey key = squadsAuraTree.get_ith_id(i);
-        return output_t<int>(key.id);
+        int uIdx = system.huntersIndex.find(hunterId);
+        if(uIdx == -1 || uIdx <= RETIRED_HUNTER) return output_t<NenAbility>(StatusType::FAILURE);
+        if(!system.huntersUnion.is_alive(uIdx)) return output_t<NenAbility>(StatusType::FAILURE);
+        ability = system.huntersUnion.partialAbility(uIdx).toAbility();
     }
     catch(bad_alloc&) {
-        return output_t<int>(StatusType::ALLOCATION_ERROR);
+        return output_t<NenAbility>(StatusType::ALLOCATION_ERROR);
     }
-    catch (...) {
-        return output_t<int>(StatusType::FAILURE);
+    catch(StatusType e) {
+        return output_t<NenAbility>(e);
     }
+    return output_t<NenAbility>(ability);
 }
 
-output_t<NenAbility> Huntech::get_partial_nen_ability(int hunterId) {
-    NenAbility ability;
-    if(hunterId <= 0) return output_t<NenAbility>(StatusType::INVALID_INPUT);
+output_t<int> Huntech::get_hunter_fights_number(int hunterId) {
+    return hunter_fights(*this, hunterId);
+}
+
+output_t<int> Huntech::get_hunter_fights_number(int hunterId) const {
+    return hunter_fights(*this, hunterId);
+}
+
+StatusType Huntech::get_hunters_fights_number(const int* hunterIds, int n,
+                                              int* fights, StatusType* results) {
+    if(n < 0 || (n > 0 && (!hunterIds || !fights || !results))) return StatusType::INVALID_INPUT;
+    // resolve the ids a group at a time so the index lookups overlap
+    int uIdx[BATCH_GROUP];
     try {
-        int uIdx = hashTable.find(hunterId);
-        if(uIdx == -1) return output_t<NenAbility>(StatusType::FAILURE);
-        if(!huntersUnion.is_alive(uIdx)) return output_t<NenAbility>(StatusType::FAILURE);
-        ability = huntersUnion.partialAbility(uIdx);
+        for(int start = 0; start < n; start += BATCH_GROUP) {
+            int group = (n - start < BATCH_GROUP) ? n - start : BATCH_GROUP;
+            huntersIndex.find_batch(hunterIds + start, uIdx, group);
+            for(int i = 0; i < group; i++) {
+                if(hunterIds[start + i] <= 0) results[start + i] = StatusType::INVALID_INPUT;
+                else if(uIdx[i] == -1) results[start + i] = StatusType::FAILURE;
+                else {
+                    fights[start + i] = (uIdx[i] <= RETIRED_HUNTER) ? RETIRED_HUNTER - uIdx[i]
+                                                                    : huntersUnion.fightsHad(uIdx[i]);
+                    results[start + i] = StatusType::SUCCESS;
+                }
+            }
+        }
     }
     catch(bad_alloc&) {
-        return output_t<NenAbility>(StatusType::ALLOCATION_ERROR);
+        return StatusType::ALLOCATION_ERROR;
     }
     catch(StatusType e) {
-        return output_t<NenAbility>(e);
+        return e;
     }
-    return output_t<NenAbility>(ability);
+    return StatusType::SUCCESS;
+}
+
+output_t<int> Huntech::get_squad_experience(int squadId) {
+    return squad_experience(*this, squadId);
+}
+
+output_t<int> Huntech::get_squad_experience(int squadId) const {
+    return squad_experience(*this, squadId);
+}
+
+output_t<int> Huntech::get_ith_collective_aura_squad(int i) {
+    if(i < 0) return output_t<int>(StatusType::FAILURE);
+    try {
+        return output_t<int>(squads.ith_by_aura(i));
+    }
+    catch(bad_alloc&) {
+        return output_t<int>(StatusType::ALLOCATION_ERROR);
+    }
+    catch (...) {
+        return output_t<int>(StatusType::FAILURE);
+    }
+}
+
+output_t<NenAbility> Huntech::get_partial_nen_ability(int hunterId) {
+    return partial_nen_ability(*this, hunterId);
+}
+
+output_t<NenAbility> Huntech::get_partial_nen_ability(int hunterId) const {
+    return partial_nen_ability(*this, hunterId);
 }
 
 StatusType Huntech::force_join(int forcingSquadId, int forcedSquadId) {
@@ -245,10 +729,15 @@ StatusType Huntech::force_join(int forcingSquadId, int forcedSquadId) {
     int squadId2 = forcedSquadId;
     if (squadId1 <= 0 || squadId2 <= 0 || squadId1 == squadId2)
         return StatusType::INVALID_INPUT;
+    if(log_broken()) return StatusType::FAILURE;
 
     try {
-        Squad& squad1 = squadsTree.search(squadId1);
-        Squad& squad2 = squadsTree.search(squadId2);
+        int slot1 = squads.find(squadId1);
+        int slot2 = squads.find(squadId2);
+        if (slot1 == -1 || slot2 == -1)
+            return StatusType::FAILURE;
+        Squad& squad1 = squads[slot1];
+        Squad& squad2 = squads[slot2];
 
         int root_1 = squad1.getUnionHead();
         int root_2 = squad2.getUnionHead();
@@ -256,48 +745,30 @@ StatusType Huntech::force_join(int forcingSquadId, int forcedSquadId) {
         if (root_1 == -1)
             return StatusType::FAILURE;
 
-        int Aura_1 = squad1.totalAura;
-
         if (root_2 != -1) {
-            int exp_1 = huntersUnion.get_exp(root_1);
-            int exp_2 = huntersUnion.get_exp(root_2);
+            USummary side_1 = huntersUnion.resolve(root_1);
+            USummary side_2 = huntersUnion.resolve(root_2);
+            int exp_1 = side_1.experience;
+            int exp_2 = side_2.experience;
 
-            NenAbility ab_1 = huntersUnion.partialAbility(huntersUnion.lastChrono(root_1));
-            NenAbility ab_2 = huntersUnion.partialAbility(huntersUnion.lastChrono(root_2));
+            const NenVector& ab_1 = squad1.totalNenAbility;
+            const NenVector& ab_2 = squad2.totalNenAbility;
 
-            if ((long long)(exp_1 + squad1.totalAura + ab_1.getEffectiveNenAbility()) <=
-                (long long)(exp_2 + squad2.totalAura + ab_2.getEffectiveNenAbility())) {
+            if ((long long)(exp_1 + squad1.totalAura + ab_1.effective()) <=
+                (long long)(exp_2 + squad2.totalAura + ab_2.effective())) {
                 return StatusType::FAILURE;
             }
 
-
-
-            AuraKey key1(Aura_1, squadId1);
-            squadsAuraTree.del(key1);
-            squad1.totalAura += squad2.totalAura;
+            squads.setAura(slot1, squad1.totalAura + squad2.totalAura);
             squad1.totalNenAbility += squad2.totalNenAbility;
 
-            try {
-                AuraKey newKey1(squad1.totalAura, squadId1);
-                squadsAuraTree.insert(newKey1, &squad1);
-            }
-            catch (...) {
-                // rollback on failure
-                squad1.totalAura -= squad2.totalAura;
-                squad1.totalNenAbility -= squad2.totalNenAbility;
-                squadsAuraTree.insert(key1, &squad1);
-                throw;
-            }
-
-
             huntersUnion.combine(root_1, root_2, 1);
             squad1.setUnionHead(huntersUnion.find(root_1));
         }
 
-        AuraKey key2(squad2.totalAura, squadId2);
-        squadsAuraTree.del(key2);
-        squadsTree.del(squadId2);
+        squads.remove(slot2);
 
+        if(!logged(WAL_FORCE_JOIN, squadId1, squadId2)) return StatusType::FAILURE;
         return StatusType::SUCCESS;
     }
     catch (bad_alloc&) {
@@ -306,4 +777,8 @@ StatusType Huntech::force_join(int forcingSquadId, int forcedSquadId) {
     catch(...) {
         return StatusType::FAILURE;
     }
-}
\ No newline at end of file
+}
+
+void Huntech::flatten() {
+    huntersUnion.flatten_all();
+}
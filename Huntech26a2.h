@@ -1,40 +1,65 @@
 #ifndef HUNTECH26A2_H_
 #define HUNTECH26A2_H_
+// an index value at or below RETIRED_HUNTER marks a hunter compacted out of
+// the union, it encodes the hunter's final fights as RETIRED_HUNTER - value.
+// that covers fights up to RETIRED_MAX_FIGHTS, a removed squad with a hunter
+// past it keeps its nodes in the union
+#define RETIRED_HUNTER -2
+#define RETIRED_MAX_FIGHTS (INT_MAX + RETIRED_HUNTER + 1)
+// compact once the dead nodes are at least this many and outnumber the live ones
+#define COMPACT_MIN_DEAD 1024
 
+#include <climits>
 #include "wet2util.h"
-#include "AvlTree.h"
-#include "DoubleHashTable.h"
+#include "AdaptiveIdIndex.h"
 #include "Union.h"
 #include "Hunter.h"
 #include "Squad.h"
+#include "SquadPool.h"
+#include "Wal.h"
+
+// one hunter of Huntech::add_hunters, the arguments add_hunter takes for it
+struct HunterSpec {
+    int hunterId;
+    NenAbility nenType;
+    int aura;
+    int fightsHad;
+};
 
 class Huntech {
 private:
-    struct AuraKey {
-        int aura;
-        int id;
-
-        AuraKey() : aura(0), id(0) {}
-        AuraKey(int a, int id) : aura(a), id(id) {}
-
-        bool operator<(const AuraKey& other) const {
-            if (aura != other.aura) return aura < other.aura;
-            return id < other.id;
-        }
-        bool operator>(const AuraKey& other) const {
-            return other < *this;
-        }
-        bool operator==(const AuraKey& other) const {
-            return aura == other.aura && id == other.id;
-        }
-    };
-
-    DoubleHashTable<int, int> hashTable;
+    AdaptiveIdIndex<int, int> huntersIndex;
     Union<Hunter> huntersUnion;
-    AvlTree<int, unique_ptr<Squad>> squadsTree;
-    AvlTree<AuraKey, Squad*> squadsAuraTree;
+    // squads by id and by aura, one record per squad
+    SquadPool squads;
+    // the log of the commands that change the system, null until open_log
+    unique_ptr<Wal> wal;
+    // changes applied so far, the lsn of the latest
+    long long lsn;
 
     Squad& find_winner_squad(int squadId1, int squadId2);
+    Squad& find_squad(int squadId);
+    const Squad& find_squad(int squadId) const;
+    void compact_hunters();
+    int duel(const Squad& squad1, const Squad& squad2,
+             const USummary& side_1, const USummary& side_2);
+    StatusType insert_hunter(int hunterId, int squadId, const NenVector& nen,
+                             int aura, int fightsHad);
+    template <class System>
+    static output_t<int> hunter_fights(System& system, int hunterId);
+    template <class System>
+    static output_t<int> squad_experience(System& system, int squadId);
+    template <class System>
+    static output_t<NenAbility> partial_nen_ability(System& system, int hunterId);
+    // count a change that succeeded, and log it when a log is open. false
+    // when the log could not take it: the change stays in memory, the log
+    // is broken and the caller answers FAILURE
+    bool logged(int op, int arg0, int arg1 = 0, int arg2 = 0, int arg3 = 0,
+                const NenVector* nen = nullptr);
+    // true once the open log broke, changes are refused from then on
+    bool log_broken() const;
+    // apply one record of the log
+    StatusType replay(const WalRecord& record);
 
 public:
     Huntech();
@@ -48,13 +73,77 @@ public:
                           const NenAbility &nenType,
                           int aura,
                           int fightsHad);
+    // add_hunter for n hunters of one squad, joined in the given order. all
+    // or nothing: an invalid entry gives INVALID_INPUT, a missing squad or a
+    // taken or repeated id FAILURE, and then no hunter is added
+    StatusType add_hunters(int squadId, const HunterSpec* hunters, int n);
+    // fill a new system from a roster file (see Roster.h), the same as
+    // replaying its adds but built in O(n). FAILURE when the system ever
+    // held a squad or a hunter, removed ones included, when the file cannot
+    // be read or one of its adds would fail, and then nothing is loaded
+    StatusType bulk_load(const char* path);
+    // the whole state in one binary file (see Snapshot.h), and back. load
+    // maps the file and copies the arrays in as they are, nothing is rebuilt.
+    // it replaces the current state, and leaves it as it was (FAILURE) if the
+    // file is missing, from another version or build, short, fails its
+    // checksum, or holds structures that do not hold together: a link out of
+    // range, a cycle, a count, tree weight or height that does not match,
+    // a hash table of non-prime size. files of the versions before the
+    // checksum get the same checks. the file keeps the lsn, save syncs an
+    // open log first so the log never lags the snapshot
+    StatusType save_snapshot(const char* path) const;
+    StatusType load_snapshot(const char* path);
+
+    // write-ahead log (see Wal.h). once open, every change that succeeds is
+    // appended to it before the call returns, and is durable once
+    // durable_lsn() reaches its lsn: records are fsynced a group at a time,
+    // when groupSize of them wait or the oldest has waited windowMicros (0 for
+    // no time limit), or on sync_log. the window is checked by the changes
+    // and by poll_log only, so a caller that goes quiet under a window must
+    // call poll_log (cheap when nothing is due) or sync_log every so often.
+    // a change whose record the log cannot take answers FAILURE although it
+    // was applied, and every change after it is refused; squad_duels and
+    // add_hunters stop there. the file must be new or end at the current
+    // lsn. the snapshot calls and recover refuse to run while it is open
+    StatusType open_log(const char* path, int groupSize, int windowMicros);
+    StatusType sync_log();
+    // sync_log if the oldest waiting record is past the window
+    StatusType poll_log();
+    // syncs and closes it
+    StatusType close_log();
+    long long last_lsn() const;
+    long long durable_lsn() const;
+    // rebuild the state after a crash: load the snapshot (an empty system
+    // when null), then replay the log's records past the snapshot's lsn, up
+    // to its torn tail. a missing log has no records. FAILURE when the log
+    // does not follow the snapshot or a record does not apply, and then the
+    // state is left as it was
+    StatusType recover(const char* snapshotPath, const char* logPath);
 
     output_t<int> squad_duel(int squadId1, int squadId2);
+    // squad_duel for n pairs, fought in order: results[i] gets the status of
+    // (squadIds1[i], squadIds2[i]) and outcomes[i] its answer when that is
+    // SUCCESS. the same as n calls to squad_duel, without their overhead
+    StatusType squad_duels(const int* squadIds1, const int* squadIds2, int n,
+                           int* outcomes, StatusType* results);
     output_t<int> get_hunter_fights_number(int hunterId);
+    // get_hunter_fights_number for n hunters at once: results[i] gets the
+    // status of hunterIds[i] and fights[i] its answer when that is SUCCESS
+    StatusType get_hunters_fights_number(const int* hunterIds, int n,
+                                         int* fights, StatusType* results);
     output_t<int> get_squad_experience(int squadId);
     output_t<int> get_ith_collective_aura_squad(int i);
     output_t<NenAbility> get_partial_nen_ability(int hunterId);
     StatusType force_join(int forcingSquadId, int forcedSquadId);
+
+    // same answers as the queries above without compressing any path, so
+    // they write nothing and readers can share a const Huntech
+    output_t<int> get_hunter_fights_number(int hunterId) const;
+    output_t<int> get_squad_experience(int squadId) const;
+    output_t<NenAbility> get_partial_nen_ability(int hunterId) const;
+    // point every hunter straight at the root of its squad, so the next queries
+    // skip the compression work (e.g. after a wave of force_joins)
+    void flatten();
 };
 
 #endif
\ No newline at end of file
@@ -3,13 +3,16 @@
 //
 
 #include "Hunter.h"
+int Hunter::getId() const {
+    return id;
+}
 int Hunter::getFights() {
     return fightsHad;
 }
 void Hunter::setFights(int fights) {
     fightsHad = fights;
 }
-NenAbility& Hunter::getNenAbility() {
+const NenVector& Hunter::getNenAbility() const {
     return ability;
 }
 bool Hunter::isAlive() const {
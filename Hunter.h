@@ -1,19 +1,21 @@
 #ifndef HUNTER_H
 #define HUNTER_H
 
-#include "wet2util.h"
+#include "NenVector.h"
 
 class Hunter {
     int id;
-    NenAbility ability;
+    NenVector ability;
     int aura;
     int fightsHad;
     bool alive;
 public:
-    Hunter(int id , const NenAbility& hAbility ,int aura, int fightsHad) : id(id) ,
+    Hunter() : id(0), aura(0), fightsHad(0), alive(false) {}
+    Hunter(int id , const NenVector& hAbility ,int aura, int fightsHad) : id(id) ,
     ability(hAbility) ,aura(aura), fightsHad(fightsHad) ,alive(true) {}
+    int getId() const;
     int getFights();
-    NenAbility& getNenAbility();
+    const NenVector& getNenAbility() const;
     void setFights(int fights);
     bool isAlive() const;
     void setAlive(bool value);
@@ -0,0 +1,129 @@
+#ifndef NENKERNELS_H
+#define NENKERNELS_H
+#define NEN_TYPES 6
+#define NEN_LANES 8
+
+// kernels over Nen vectors stored as NEN_LANES ints (NEN_TYPES counters and
+// zero padding). with SSE2 the lanes go as two 128 bit registers, otherwise
+// the plain loops are left to the compiler
+#if defined(__SSE2__) || defined(_M_X64)
+#define NEN_SSE2
+#include <emmintrin.h>
+#endif
+
+// same matchup circle as NenAbility::getNenMatrix, known at compile time
+// so the score below needs no function call and no static guard
+constexpr int NEN_MATRIX[NEN_TYPES][NEN_TYPES] = {
+    // E   Em  Tr  Co  Ma  Sp
+    {  0, +1, +1, -1, -1, -1 }, // Enhancer
+    { -1,  0, +1, +1, -1, -1 }, // Emitter
+    { -1, -1,  0, +1, +1, -1 }, // Transmuter
+    { +1, -1, -1,  0, +1, -1 }, // Conjurer
+    { +1, +1, -1, -1,  0, -1 }, // Manipulator
+    { +1, +1, +1, +1, +1,  0 }  // Specialist
+};
+
+inline void nenAdd(int* dst, const int* src) {
+#ifdef NEN_SSE2
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    _mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), _mm_loadu_si128(s)));
+    _mm_storeu_si128(d + 1, _mm_add_epi32(_mm_loadu_si128(d + 1), _mm_loadu_si128(s + 1)));
+#else
+    for (int i = 0; i < NEN_LANES; i++) dst[i] += src[i];
+#endif
+}
+
+inline void nenSub(int* dst, const int* src) {
+#ifdef NEN_SSE2
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    _mm_storeu_si128(d, _mm_sub_epi32(_mm_loadu_si128(d), _mm_loadu_si128(s)));
+    _mm_storeu_si128(d + 1, _mm_sub_epi32(_mm_loadu_si128(d + 1), _mm_loadu_si128(s + 1)));
+#else
+    for (int i = 0; i < NEN_LANES; i++) dst[i] -= src[i];
+#endif
+}
+
+inline void nenNegate(int* dst, const int* src) {
+#ifdef NEN_SSE2
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128(d, _mm_sub_epi32(zero, _mm_loadu_si128(s)));
+    _mm_storeu_si128(d + 1, _mm_sub_epi32(zero, _mm_loadu_si128(s + 1)));
+#else
+    for (int i = 0; i < NEN_LANES; i++) dst[i] = -src[i];
+#endif
+}
+
+inline int nenDot(const int* a, const int* b) {
+    int sum = 0;
+    for (int i = 0; i < NEN_TYPES; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// strength metric of force_join, same as NenAbility::getEffectiveNenAbility
+inline int nenEffective(const int* a) {
+    return nenDot(a, a);
+}
+
+// entries J.. of row I of M * b. the indices are template arguments, so
+// NEN_MATRIX[I][J] is a constant and each term folds into an add, a
+// subtract or nothing
+template <int I, int J>
+struct NenRow {
+    static constexpr int dot(const int* b) {
+        return NEN_MATRIX[I][J] * b[J] + NenRow<I, J + 1>::dot(b);
+    }
+};
+
+template <int I>
+struct NenRow<I, NEN_TYPES> {
+    static constexpr int dot(const int*) {
+        return 0;
+    }
+};
+
+// rows I.. of A * (M * B)
+template <int I>
+struct NenScore {
+    static constexpr int of(const int* a, const int* b) {
+        return a[I] * NenRow<I, 0>::dot(b) + NenScore<I + 1>::of(a, b);
+    }
+};
+
+template <>
+struct NenScore<NEN_TYPES> {
+    static constexpr int of(const int*, const int*) {
+        return 0;
+    }
+};
+
+// A * M * B as the matrix-vector product M * B followed by a dot product
+// with A, unrolled from NEN_MATRIX at compile time - no call, no loop over
+// the matrix and no static guard as in NenAbility::compareNenTypes.
+// positive when a beats b, same sign as NenAbility::compareNenTypes
+constexpr int nenMatchupScore(const int* a, const int* b) {
+    return NenScore<0>::of(a, b);
+}
+
+// the score of one hunter of type i against one of type j is M[i][j], and
+// the matrix is antisymmetric (the duel tie-break reads one score both ways)
+constexpr bool nenScoreFollowsMatrix() {
+    for (int i = 0; i < NEN_TYPES; i++) {
+        for (int j = 0; j < NEN_TYPES; j++) {
+            int a[NEN_TYPES] = {};
+            int b[NEN_TYPES] = {};
+            a[i] = 1;
+            b[j] = 1;
+            if (nenMatchupScore(a, b) != NEN_MATRIX[i][j]) return false;
+            if (NEN_MATRIX[i][j] != -NEN_MATRIX[j][i]) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(nenScoreFollowsMatrix(), "nenMatchupScore must follow NEN_MATRIX");
+
+#endif //NENKERNELS_H
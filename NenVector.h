@@ -0,0 +1,101 @@
+#ifndef NENVECTOR_H
+#define NENVECTOR_H
+
+#include "wet2util.h"
+#include "NenKernels.h"
+
+// internal form of a NenAbility: no virtual destructor and no vptr, just the
+// six counters padded to eight int lanes so the arithmetic maps onto the
+// vector kernels of NenKernels.h.
+// lanes NEN_TYPES..NEN_LANES-1 are always 0. converted from and to the
+// public NenAbility only where Huntech takes or returns one
+struct NenVector {
+    int lanes[NEN_LANES];
+
+    NenVector() {
+        for (int i = 0; i < NEN_LANES; i++) lanes[i] = 0;
+    }
+
+    NenVector& operator+=(const NenVector& other) {
+        nenAdd(lanes, other.lanes);
+        return *this;
+    }
+
+    NenVector& operator-=(const NenVector& other) {
+        nenSub(lanes, other.lanes);
+        return *this;
+    }
+
+    friend NenVector operator+(NenVector a, const NenVector& b) {
+        a += b;
+        return a;
+    }
+
+    friend NenVector operator-(NenVector a, const NenVector& b) {
+        a -= b;
+        return a;
+    }
+
+    NenVector operator-() const {
+        NenVector res;
+        nenNegate(res.lanes, lanes);
+        return res;
+    }
+
+    // same as NenAbility::getEffectiveNenAbility
+    int effective() const {
+        return nenEffective(lanes);
+    }
+
+    // > 0 when this beats other, same sign as the NenAbility comparisons
+    int matchup(const NenVector& other) const {
+        return nenMatchupScore(lanes, other.lanes);
+    }
+
+    // NenAbility keeps its counters private, so they are recovered from the
+    // public norm: |a - e_j|^2 = |a|^2 - 2 * a_j + 1 for the unit ability e_j.
+    // exact as long as getEffectiveNenAbility itself does not overflow
+    static NenVector fromAbility(const NenAbility& ability) {
+        NenVector res;
+        int norm = ability.getEffectiveNenAbility();
+        for (int j = 0; j < NEN_TYPES; j++) {
+            int shifted = (ability - unit(j)).getEffectiveNenAbility();
+            res.lanes[j] = (norm + 1 - shifted) / 2;
+        }
+        return res;
+    }
+
+    // build the NenAbility back from unit abilities, doubling per bit
+    NenAbility toAbility() const {
+        NenAbility res;
+        for (int j = 0; j < NEN_TYPES; j++) {
+            unsigned int count = lanes[j] < 0 ? 0u - (unsigned int)lanes[j] : (unsigned int)lanes[j];
+            NenAbility power = unit(j);
+            while (count) {
+                if (count & 1u) {
+                    if (lanes[j] < 0) res -= power;
+                    else res += power;
+                }
+                count >>= 1;
+                if (count) power += power;
+            }
+        }
+        return res;
+    }
+
+private:
+    // the six one-hunter abilities, built once
+    static const NenAbility& unit(int type) {
+        static const NenAbility units[NEN_TYPES] = {
+            NenAbility("Enhancer"),
+            NenAbility("Emitter"),
+            NenAbility("Transmuter"),
+            NenAbility("Conjurer"),
+            NenAbility("Manipulator"),
+            NenAbility("Specialist")
+        };
+        return units[type];
+    }
+};
+
+#endif //NENVECTOR_H
@@ -0,0 +1,15 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+// lookups a batch starts before it uses the first of them: enough to cover
+// a cache miss, few enough for a group's state to stay on the stack
+#define BATCH_GROUP 16
+
+// hint the cpu to start loading addr, ignored by compilers without the builtin
+#if defined(__GNUC__) || defined(__clang__)
+#define HASH_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HASH_PREFETCH(addr) ((void)(addr))
+#endif
+
+#endif //PREFETCH_H
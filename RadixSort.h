@@ -0,0 +1,42 @@
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+#define RADIX_BITS 16
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+#include <memory>
+
+using namespace std;
+
+// stable sort of the indices order[0..n) by keys[order[i]], for keys >= 0.
+// two counting passes over 16 bit digits, a pass is skipped when every key
+// has the same digit there (small keys need only the low one). O(n) with
+// scratch of n ints, the answer ends up back in order
+inline void radixSortBy(const int* keys, int* order, int* scratch, int n) {
+    unique_ptr<int[]> counts(new int[RADIX_BUCKETS]);
+    int* from = order;
+    int* to = scratch;
+    for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+        for (int d = 0; d < RADIX_BUCKETS; d++) counts[d] = 0;
+        for (int i = 0; i < n; i++) {
+            counts[((unsigned int)keys[from[i]] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+        if (n == 0 || counts[((unsigned int)keys[from[0]] >> shift) & (RADIX_BUCKETS - 1)] == n) continue;
+        int sum = 0;
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            int count = counts[d];
+            counts[d] = sum;
+            sum += count;
+        }
+        for (int i = 0; i < n; i++) {
+            to[counts[((unsigned int)keys[from[i]] >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+        }
+        int* temp = from;
+        from = to;
+        to = temp;
+    }
+    if (from != order) {
+        for (int i = 0; i < n; i++) order[i] = from[i];
+    }
+}
+
+#endif //RADIXSORT_H
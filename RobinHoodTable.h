@@ -0,0 +1,179 @@
+#ifndef ROBINHOODTABLE_H
+#define ROBINHOODTABLE_H
+#define ROBIN_HOOD_LOAD_FACTOR 0.9
+
+// linear probing table with the same interface as DoubleHashTable.
+// every slot remembers how far it is from its home slot, an insertion steals
+// the slot of any entry that is closer to home than itself, and a removal
+// shifts the following run one step back - so there are never tombstones
+template <typename K, typename V>
+class RobinHoodTable {
+private:
+    struct Entry {
+        K key;
+        V value;
+        int dist; // distance from the home slot, -1 when empty
+
+        Entry() : dist(-1) {}
+    };
+
+    Entry* table;
+    int capacity; // always a power of 2
+    int shift;    // 32 - log2(capacity)
+    int size;
+
+    RobinHoodTable(const RobinHoodTable&) = delete;
+    RobinHoodTable& operator=(const RobinHoodTable&) = delete;
+
+    // fibonacci hashing, the top bits of the product are well mixed even for
+    // consecutive ids which plain modulo would put in one long run
+    int home(const K& key) const {
+        if (shift == 32) return 0;
+        unsigned int h = static_cast<unsigned int>(key) * 2654435769u;
+        return (int)(h >> shift);
+    }
+
+    int next(int idx) const {
+        return (idx + 1) & (capacity - 1);
+    }
+
+    // place an entry known to be missing, return the slot it landed in
+    int place(K key, V value) {
+        int current = home(key);
+        int dist = 0;
+        int landed = -1;
+        while (true) {
+            if (table[current].dist == -1) {
+                table[current].key = key;
+                table[current].value = value;
+                table[current].dist = dist;
+                size++;
+                return (landed != -1) ? landed : current;
+            }
+            if (table[current].dist < dist) {
+                // the resident is richer - swap and keep placing the resident
+                K tempKey = table[current].key;
+                V tempValue = table[current].value;
+                int tempDist = table[current].dist;
+                table[current].key = key;
+                table[current].value = value;
+                table[current].dist = dist;
+                if (landed == -1) landed = current;
+                key = tempKey;
+                value = tempValue;
+                dist = tempDist;
+            }
+            current = next(current);
+            dist++;
+        }
+    }
+
+    // return the slot of key or -1, stop as soon as the key would have
+    // stolen the slot it looks at
+    int locate(const K& key) const {
+        int current = home(key);
+        for (int dist = 0; dist <= capacity; dist++) {
+            if (table[current].dist < dist) return -1;
+            if (table[current].key == key) return current;
+            current = next(current);
+        }
+        return -1;
+    }
+
+    // double the array and place every entry again
+    void rehash() {
+        int oldCapacity = capacity;
+        Entry* oldTable = table;
+
+        capacity = capacity * 2;
+        shift--;
+        table = new Entry[capacity];
+        size = 0;
+
+        for (int i = 0; i < oldCapacity; i++) {
+            if (oldTable[i].dist != -1) {
+                place(oldTable[i].key, oldTable[i].value);
+            }
+        }
+        delete[] oldTable;
+    }
+
+public:
+    RobinHoodTable(int initCapacity = 16) : capacity(1), shift(32), size(0) {
+        while (capacity < initCapacity) {
+            capacity *= 2;
+            shift--;
+        }
+        table = new Entry[capacity];
+    }
+
+    ~RobinHoodTable() {
+        delete[] table;
+    }
+
+    void insert(const K& key, const V& value) {
+        bool inserted = false;
+        try_emplace(key, inserted) = value;
+    }
+
+    // same contract as DoubleHashTable::try_emplace
+    V& try_emplace(const K& key, bool& inserted) {
+        int found = locate(key);
+        if (found != -1) {
+            inserted = false;
+            return table[found].value;
+        }
+        if ((double)(size + 1) / capacity > ROBIN_HOOD_LOAD_FACTOR) {
+            rehash();
+        }
+        inserted = true;
+        return table[place(key, V())].value;
+    }
+
+    V find(const K& key) const {
+        int found = locate(key);
+        if (found == -1) return -1;
+        return table[found].value;
+    }
+
+    // backward shift - pull every following entry that is away from home
+    // one step closer, until an empty slot or an entry already at home
+    void remove(const K& key) {
+        int current = locate(key);
+        if (current == -1) return;
+        int following = next(current);
+        while (table[following].dist > 0) {
+            table[current].key = table[following].key;
+            table[current].value = table[following].value;
+            table[current].dist = table[following].dist - 1;
+            current = following;
+            following = next(following);
+        }
+        table[current].dist = -1;
+        size--;
+    }
+
+    int count() const {
+        return size;
+    }
+
+    // probe length of an entry is its distance from home plus one
+    int maxProbeLength() const {
+        int longest = 0;
+        for (int i = 0; i < capacity; i++) {
+            if (table[i].dist + 1 > longest) longest = table[i].dist + 1;
+        }
+        return longest;
+    }
+
+    double averageProbeLength() const {
+        if (size == 0) return 0;
+        long long total = 0;
+        for (int i = 0; i < capacity; i++) {
+            if (table[i].dist != -1) total += table[i].dist + 1;
+        }
+        return (double)total / size;
+    }
+};
+
+#endif //ROBINHOODTABLE_H
@@ -0,0 +1,121 @@
+#include <cstring>
+#include "Roster.h"
+#include "RadixSort.h"
+
+Roster::Roster() : squadCount(0), hunterCount(0) {}
+
+StatusType Roster::read(const char* path) {
+    TextReader reader(path);
+    if(!reader.isOpen()) return StatusType::FAILURE;
+    StatusType status = readSquads(reader);
+    if(status == StatusType::SUCCESS) status = readHunters(reader);
+    if(status == StatusType::SUCCESS && !reader.atEnd()) status = StatusType::FAILURE;
+    if(status == StatusType::SUCCESS) status = arrange();
+    return status;
+}
+
+StatusType Roster::readSquads(TextReader& reader) {
+    if(!reader.readInt(squadCount) || squadCount < 0) return StatusType::FAILURE;
+    squadIds.reset(new int[squadCount]);
+    for(int s = 0; s < squadCount; s++) {
+        if(!reader.readInt(squadIds[s]) || squadIds[s] <= 0) return StatusType::FAILURE;
+    }
+    return StatusType::SUCCESS;
+}
+
+StatusType Roster::readHunters(TextReader& reader) {
+    if(!reader.readInt(hunterCount) || hunterCount < 0) return StatusType::FAILURE;
+    hunterIds.reset(new int[hunterCount]);
+    hunterSquads.reset(new int[hunterCount]);
+    hunterAuras.reset(new int[hunterCount]);
+    hunterFights.reset(new int[hunterCount]);
+    hunterTypes.reset(new unsigned char[hunterCount]);
+
+    // the type names met so far and their lanes, a new name is checked once
+    // through NenAbility and then matched by name
+    char word[ROSTER_WORD];
+    char names[NEN_TYPES][ROSTER_WORD];
+    unsigned char lanes[NEN_TYPES];
+    int known = 0;
+    for(int h = 0; h < hunterCount; h++) {
+        if(!reader.readInt(hunterIds[h]) || !reader.readInt(hunterSquads[h]) ||
+           !reader.readWord(word, ROSTER_WORD) || !reader.readInt(hunterAuras[h]) ||
+           !reader.readInt(hunterFights[h])) return StatusType::FAILURE;
+        if(hunterIds[h] <= 0 || hunterSquads[h] <= 0 || hunterAuras[h] < 0 || hunterFights[h] < 0)
+            return StatusType::FAILURE;
+        int k = 0;
+        while(k < known && strcmp(names[k], word) != 0) k++;
+        if(k == known) {
+            NenAbility ability(word);
+            if(!ability.isValid()) return StatusType::FAILURE;
+            NenVector nen = NenVector::fromAbility(ability);
+            int lane = 0;
+            while(nen.lanes[lane] != 1) lane++;
+            strcpy(names[known], word);
+            lanes[known] = (unsigned char)lane;
+            known++;
+        }
+        hunterTypes[h] = lanes[k];
+    }
+    return StatusType::SUCCESS;
+}
+
+StatusType Roster::arrange() {
+    int larger = squadCount > hunterCount ? squadCount : hunterCount;
+    unique_ptr<int[]> scratch(new int[larger]);
+
+    // squads by id, a repeated id is an add_squad that fails
+    unique_ptr<int[]> squadsById(new int[squadCount]);
+    for(int s = 0; s < squadCount; s++) squadsById[s] = s;
+    radixSortBy(squadIds.get(), squadsById.get(), scratch.get(), squadCount);
+    for(int i = 1; i < squadCount; i++) {
+        if(squadIds[squadsById[i]] == squadIds[squadsById[i - 1]]) return StatusType::FAILURE;
+    }
+
+    // hunters by id, the same for add_hunter
+    huntersById.reset(new int[hunterCount]);
+    for(int h = 0; h < hunterCount; h++) huntersById[h] = h;
+    radixSortBy(hunterIds.get(), huntersById.get(), scratch.get(), hunterCount);
+    for(int i = 1; i < hunterCount; i++) {
+        if(hunterIds[huntersById[i]] == hunterIds[huntersById[i - 1]]) return StatusType::FAILURE;
+    }
+
+    // the squad of every hunter, walking the hunters by squad id along the
+    // squads by id. a squad id that is not there is an add_hunter that fails
+    unique_ptr<int[]> squadOf(new int[hunterCount]);
+    {
+        unique_ptr<int[]> bySquadId(new int[hunterCount]);
+        for(int h = 0; h < hunterCount; h++) bySquadId[h] = h;
+        radixSortBy(hunterSquads.get(), bySquadId.get(), scratch.get(), hunterCount);
+        int p = 0;
+        for(int i = 0; i < hunterCount; i++) {
+            int h = bySquadId[i];
+            while(p < squadCount && squadIds[squadsById[p]] < hunterSquads[h]) p++;
+            if(p == squadCount || squadIds[squadsById[p]] != hunterSquads[h]) return StatusType::FAILURE;
+            squadOf[h] = squadsById[p];
+        }
+    }
+
+    // the hunters under their squads, a counting sort on the squad that keeps
+    // the file order inside each one, and the squads' sums on the way
+    squadFirst.reset(new int[squadCount + 1]);
+    squadAuras.reset(new int[squadCount]);
+    squadNen.reset(new NenVector[squadCount]);
+    for(int s = 0; s <= squadCount; s++) squadFirst[s] = 0;
+    for(int s = 0; s < squadCount; s++) squadAuras[s] = 0;
+    for(int h = 0; h < hunterCount; h++) {
+        int s = squadOf[h];
+        squadFirst[s + 1]++;
+        squadAuras[s] += hunterAuras[h];
+        squadNen[s].lanes[hunterTypes[h]]++;
+    }
+    for(int s = 0; s < squadCount; s++) squadFirst[s + 1] += squadFirst[s];
+    bySquad.reset(new int[hunterCount]);
+    for(int s = 0; s < squadCount; s++) scratch[s] = squadFirst[s];
+    for(int h = 0; h < hunterCount; h++) bySquad[scratch[squadOf[h]]++] = h;
+
+    // the squads by id once more, stably by aura
+    squadsByAura = move(squadsById);
+    radixSortBy(squadAuras.get(), squadsByAura.get(), scratch.get(), squadCount);
+    return StatusType::SUCCESS;
+}
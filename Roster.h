@@ -0,0 +1,55 @@
+#ifndef ROSTER_H
+#define ROSTER_H
+#define ROSTER_WORD 32
+
+#include <memory>
+#include "wet2util.h"
+#include "NenVector.h"
+#include "TextReader.h"
+
+using namespace std;
+
+// the squads and hunters of a roster file, read and checked in full before
+// any of it goes into a Huntech. the file is whitespace separated text:
+//   <number of squads> then every <squadId>
+//   <number of hunters> then every <hunterId> <squadId> <nenType> <aura> <fightsHad>
+// it stands for add_squad of every squad in file order and then add_hunter
+// of every hunter in file order, and read only accepts it when each of those
+// adds would succeed on an empty system. besides the file's columns it keeps
+// the orders the loader builds from, all found by radix sorts in O(n)
+class Roster {
+public:
+    int squadCount;
+    int hunterCount;
+
+    // per squad, in file order
+    unique_ptr<int[]> squadIds;
+    unique_ptr<int[]> squadAuras;       // sum over its hunters
+    unique_ptr<NenVector[]> squadNen;   // sum over its hunters
+    unique_ptr<int[]> squadFirst;       // its hunters are bySquad[squadFirst[s]..squadFirst[s + 1])
+    unique_ptr<int[]> squadsByAura;     // squads by (aura, id), the aura order of SquadPool
+
+    // per hunter, in file order
+    unique_ptr<int[]> hunterIds;
+    unique_ptr<int[]> hunterSquads;
+    unique_ptr<int[]> hunterAuras;
+    unique_ptr<int[]> hunterFights;
+    unique_ptr<unsigned char[]> hunterTypes; // lane of the hunter's one Nen type
+    unique_ptr<int[]> bySquad;          // hunters grouped by squad in file order of both
+    unique_ptr<int[]> huntersById;      // hunters by id
+
+    Roster();
+    // SUCCESS, or FAILURE when the file cannot be read, is malformed or
+    // holds an add that would not succeed. throws bad_alloc
+    StatusType read(const char* path);
+
+private:
+    Roster(const Roster&) = delete;
+    Roster& operator=(const Roster&) = delete;
+
+    StatusType readSquads(TextReader& reader);
+    StatusType readHunters(TextReader& reader);
+    StatusType arrange();
+};
+
+#endif //ROSTER_H
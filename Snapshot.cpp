@@ -0,0 +1,194 @@
+#include <cstring>
+#include <new>
+#include "Snapshot.h"
+#include "wet2util.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SNAPSHOT_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SNAPSHOT_FNV_OFFSET 14695981039346656037ull
+#define SNAPSHOT_FNV_PRIME 1099511628211ull
+
+SnapshotChecksum::SnapshotChecksum() : hash(SNAPSHOT_FNV_OFFSET), length(0), tailSize(0) {}
+
+void SnapshotChecksum::add(const void* data, size_t bytes) {
+    const unsigned char* at = static_cast<const unsigned char*>(data);
+    length += bytes;
+    while(tailSize > 0 && tailSize < 8 && bytes > 0) {
+        tail[tailSize++] = *at++;
+        bytes--;
+    }
+    if(tailSize == 8) {
+        unsigned long long word;
+        memcpy(&word, tail, sizeof(word));
+        hash = (hash ^ word) * SNAPSHOT_FNV_PRIME;
+        tailSize = 0;
+    }
+    for(; bytes >= 8; at += 8, bytes -= 8) {
+        unsigned long long word;
+        memcpy(&word, at, sizeof(word));
+        hash = (hash ^ word) * SNAPSHOT_FNV_PRIME;
+    }
+    memcpy(tail + tailSize, at, bytes);
+    tailSize += (int)bytes;
+}
+
+// the last partial word zero padded, then the length so that padding and
+// trailing zero bytes differ
+unsigned long long SnapshotChecksum::value() const {
+    unsigned long long word = 0;
+    memcpy(&word, tail, tailSize);
+    unsigned long long result = (hash ^ word) * SNAPSHOT_FNV_PRIME;
+    return (result ^ length) * SNAPSHOT_FNV_PRIME;
+}
+
+SnapshotWriter::SnapshotWriter(const char* target) : path(nullptr), tempPath(nullptr),
+                                                     file(nullptr), failed(false) {
+    size_t length = strlen(target);
+    path = new char[length + 1];
+    try {
+        tempPath = new char[length + 5];
+    }
+    catch (...) {
+        delete[] path;
+        throw;
+    }
+    memcpy(path, target, length + 1);
+    memcpy(tempPath, target, length);
+    memcpy(tempPath + length, ".tmp", 5);
+    file = fopen(tempPath, "wb");
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if(file) {
+        fclose(file);
+        remove(tempPath);
+    }
+    delete[] path;
+    delete[] tempPath;
+}
+
+bool SnapshotWriter::isOpen() const {
+    return file != nullptr;
+}
+
+void SnapshotWriter::write(const void* data, size_t bytes) {
+    if(failed || bytes == 0) return;
+    sum.add(data, bytes);
+    if(fwrite(data, 1, bytes, file) != bytes) failed = true;
+}
+
+void SnapshotWriter::writeInt(int value) {
+    write(&value, sizeof(value));
+}
+
+void SnapshotWriter::writeChecksum() {
+    unsigned long long value = sum.value();
+    write(&value, sizeof(value));
+}
+
+bool SnapshotWriter::commit() {
+    if(!file) return false;
+    if(fflush(file) != 0) failed = true;
+#ifdef SNAPSHOT_MMAP
+    if(!failed && fsync(fileno(file)) != 0) failed = true;
+#endif
+    if(fclose(file) != 0) failed = true;
+    file = nullptr;
+    if(!failed && rename(tempPath, path) != 0) failed = true;
+    if(failed) remove(tempPath);
+    return !failed;
+}
+
+SnapshotReader::SnapshotReader(const char* path) : data(nullptr), size(0), pos(0), mapped(false) {
+#ifdef SNAPSHOT_MMAP
+    int fd = open(path, O_RDONLY);
+    if(fd == -1) return;
+    struct stat info;
+    if(fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* map = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(map != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+#endif
+            data = static_cast<char*>(map);
+            size = (size_t)info.st_size;
+            mapped = true;
+        }
+    }
+    close(fd);
+    if(mapped) return;
+#endif
+    // no mmap, or it refused the file: read it all into memory
+    FILE* file = fopen(path, "rb");
+    if(!file) return;
+    if(fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        if(length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            try {
+                data = new char[length];
+            }
+            catch (...) {
+                fclose(file);
+                throw;
+            }
+            if(fread(data, 1, (size_t)length, file) == (size_t)length) size = (size_t)length;
+            else {
+                delete[] data;
+                data = nullptr;
+            }
+        }
+    }
+    fclose(file);
+}
+
+SnapshotReader::~SnapshotReader() {
+#ifdef SNAPSHOT_MMAP
+    if(mapped) {
+        munmap(data, size);
+        return;
+    }
+#endif
+    delete[] data;
+}
+
+bool SnapshotReader::isOpen() const {
+    return data != nullptr;
+}
+
+const void* SnapshotReader::read(size_t bytes) {
+    if(bytes > size - pos) throw StatusType::FAILURE;
+    const void* at = data + pos;
+    pos += bytes;
+    return at;
+}
+
+int SnapshotReader::readInt() {
+    int value;
+    memcpy(&value, read(sizeof(value)), sizeof(value));
+    return value;
+}
+
+size_t SnapshotReader::remaining() const {
+    return size - pos;
+}
+
+bool SnapshotReader::atEnd() const {
+    return pos == size;
+}
+
+bool SnapshotReader::verifyChecksum() {
+    unsigned long long stored;
+    if(size - pos < sizeof(stored)) return false;
+    SnapshotChecksum sum;
+    sum.add(data, size - sizeof(stored));
+    memcpy(&stored, data + size - sizeof(stored), sizeof(stored));
+    if(stored != sum.value()) return false;
+    size -= sizeof(stored);
+    return true;
+}
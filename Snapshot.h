@@ -0,0 +1,88 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#define SNAPSHOT_MAGIC "HUNTSNAP"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION 3
+// version 2 files end without the checksum, version 1 files also have no
+// lsn after the layout and load at lsn 0
+#define SNAPSHOT_VERSION_NO_CHECKSUM 2
+#define SNAPSHOT_VERSION_NO_LSN 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+#include <cstdio>
+#include <cstddef>
+
+// the byte streams of a Huntech snapshot. the structures write their
+// counters and raw arrays one after the other, no padding and no pointers
+// (every link in them is an index), so the file means the same wherever it
+// is mapped. the header tells the version, the byte order and the record
+// sizes it was written with, a reader on a different build refuses it. the
+// file ends with a checksum of everything before it, checked before any of
+// the stored indices is trusted
+
+// 64-bit FNV-1a over 8-byte words, fed in pieces of any size. a word per
+// multiply keeps it well below the cost of copying the arrays
+class SnapshotChecksum {
+    unsigned long long hash;
+    unsigned long long length;
+    unsigned char tail[8];
+    int tailSize;
+
+public:
+    SnapshotChecksum();
+    void add(const void* data, size_t bytes);
+    unsigned long long value() const;
+};
+
+// writes to path.tmp and renames it over path on commit, so a crash in the
+// middle leaves the last snapshot whole
+class SnapshotWriter {
+    char* path;
+    char* tempPath;
+    FILE* file;
+    bool failed;
+    SnapshotChecksum sum;
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+public:
+    explicit SnapshotWriter(const char* path);
+    ~SnapshotWriter();
+
+    bool isOpen() const;
+    void write(const void* data, size_t bytes);
+    void writeInt(int value);
+    // the checksum of everything written so far, the last thing in the file
+    void writeChecksum();
+    // flush to disk and put the file in place, false if anything failed
+    bool commit();
+};
+
+// the whole file at once: mapped where mmap exists, read into one buffer
+// otherwise. a read past the end throws FAILURE
+class SnapshotReader {
+    char* data;
+    size_t size;
+    size_t pos;
+    bool mapped;
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+public:
+    explicit SnapshotReader(const char* path);
+    ~SnapshotReader();
+
+    bool isOpen() const;
+    // the next bytes of the file, good while the reader lives
+    const void* read(size_t bytes);
+    int readInt();
+    size_t remaining() const;
+    bool atEnd() const;
+    // true when the file ends with the checksum of the rest of it, which is
+    // then cut off so atEnd comes before it
+    bool verifyChecksum();
+};
+
+#endif //SNAPSHOT_H
@@ -1,7 +1,10 @@
 
 #include "Squad.h"
 
-int Squad::getUnionHead() {
+int Squad::getId() const {
+    return id;
+}
+int Squad::getUnionHead() const {
     return uHeadIdx;
 }
 void Squad::setUnionHead(int uHead) {
@@ -5,20 +5,33 @@
 #ifndef SQUAD_H
 #define SQUAD_H
 
-
+#include "NenVector.h"
 
 class Squad {
     int id;
     int uHeadIdx; // union Head Index
+
+    // hooks of the SquadPool holding this squad, pool slots with -1 for none:
+    // the id hash chain (next also links the free slots) and the aura tree
+    int hashNext;
+    int hashPrev;
+    int auraParent;
+    int auraLeft;
+    int auraRight;
+    int auraHeight;
+    int auraWeight;
+    friend class SquadPool;
 public:
     int totalAura;
-    int totalNenAbility;
+    NenVector totalNenAbility; // sum over the squad's hunters, kept by add_hunter and force_join
     int Experience;
 
 
-    explicit Squad(int id) : id(id) , uHeadIdx(-1), totalAura(0),
-    totalNenAbility(0), Experience(0){}
-    int getUnionHead();
+    explicit Squad(int id) : id(id) , uHeadIdx(-1), hashNext(-1), hashPrev(-1),
+    auraParent(-1), auraLeft(-1), auraRight(-1), auraHeight(0), auraWeight(1),
+    totalAura(0), totalNenAbility(), Experience(0){}
+    int getId() const;
+    int getUnionHead() const;
     void setUnionHead(int uHead);
 };
 
@@ -0,0 +1,444 @@
+#include <new>
+#include <cstring>
+#include <memory>
+#include "SquadPool.h"
+#include "wet2util.h"
+
+SquadPool::SquadPool() : squads(nullptr), used(0), capacity(0), buckets(nullptr),
+                         bucketBits(0), count(0), freeHead(-1), auraRoot(-1) {
+    buckets = new int[SQUAD_FIRST_BUCKETS];
+    for(int i = 0; i < SQUAD_FIRST_BUCKETS; i++) buckets[i] = -1;
+    while((1 << bucketBits) < SQUAD_FIRST_BUCKETS) bucketBits++;
+}
+
+SquadPool::~SquadPool() {
+    for(int i = 0; i < used; i++) squads[i].~Squad();
+    ::operator delete(squads);
+    delete[] buckets;
+}
+
+// double the record array, nothing changes if the allocation fails
+void SquadPool::grow() {
+    int newCapacity = capacity == 0 ? SQUAD_FIRST_BUCKETS : capacity * 2;
+    Squad* temp = static_cast<Squad*>(::operator new(sizeof(Squad) * newCapacity));
+    for(int i = 0; i < used; i++) {
+        new (&temp[i]) Squad(squads[i]);
+        squads[i].~Squad();
+    }
+    ::operator delete(squads);
+    squads = temp;
+    capacity = newCapacity;
+}
+
+// fibonacci hashing, the top bucketBits bits of id * 2^32 / phi
+int SquadPool::bucketOf(int id) const {
+    return (int)(((unsigned int)id * 2654435769u) >> (32 - bucketBits));
+}
+
+// double the buckets and chain every squad again, nothing changes if the
+// allocation fails
+void SquadPool::growBuckets() {
+    int newCount = 1 << (bucketBits + 1);
+    int* temp = new int[newCount];
+    for(int i = 0; i < newCount; i++) temp[i] = -1;
+    delete[] buckets;
+    buckets = temp;
+    bucketBits++;
+    for(int slot = 0; slot < used; slot++) {
+        if(squads[slot].id != 0) hashLink(slot);
+    }
+}
+
+void SquadPool::hashLink(int slot) {
+    Squad& squad = squads[slot];
+    int bucket = bucketOf(squad.id);
+    squad.hashPrev = -1;
+    squad.hashNext = buckets[bucket];
+    if(squad.hashNext != -1) squads[squad.hashNext].hashPrev = slot;
+    buckets[bucket] = slot;
+}
+
+void SquadPool::hashUnlink(int slot) {
+    Squad& squad = squads[slot];
+    if(squad.hashPrev != -1) squads[squad.hashPrev].hashNext = squad.hashNext;
+    else buckets[bucketOf(squad.id)] = squad.hashNext;
+    if(squad.hashNext != -1) squads[squad.hashNext].hashPrev = squad.hashPrev;
+}
+
+bool SquadPool::auraLess(int a, int b) const {
+    const Squad& first = squads[a];
+    const Squad& second = squads[b];
+    if(first.totalAura != second.totalAura) return first.totalAura < second.totalAura;
+    return first.id < second.id;
+}
+
+int SquadPool::height(int slot) const {
+    return slot == -1 ? -1 : squads[slot].auraHeight;
+}
+
+int SquadPool::weight(int slot) const {
+    return slot == -1 ? 0 : squads[slot].auraWeight;
+}
+
+int SquadPool::balance(int slot) const {
+    if(slot == -1) return 0;
+    return height(squads[slot].auraLeft) - height(squads[slot].auraRight);
+}
+
+void SquadPool::updateStats(int slot) {
+    Squad& squad = squads[slot];
+    int lh = height(squad.auraLeft);
+    int rh = height(squad.auraRight);
+    squad.auraHeight = 1 + (lh > rh ? lh : rh);
+    squad.auraWeight = 1 + weight(squad.auraLeft) + weight(squad.auraRight);
+}
+
+// put newSlot (may be -1) where oldSlot hangs from its parent
+void SquadPool::replace(int oldSlot, int newSlot) {
+    int parent = squads[oldSlot].auraParent;
+    if(parent == -1) auraRoot = newSlot;
+    else if(squads[parent].auraLeft == oldSlot) squads[parent].auraLeft = newSlot;
+    else squads[parent].auraRight = newSlot;
+    if(newSlot != -1) squads[newSlot].auraParent = parent;
+}
+
+int SquadPool::rotateLeft(int slot) {
+    int right = squads[slot].auraRight;
+    int middle = squads[right].auraLeft;
+    squads[slot].auraRight = middle;
+    if(middle != -1) squads[middle].auraParent = slot;
+    replace(slot, right);
+    squads[right].auraLeft = slot;
+    squads[slot].auraParent = right;
+    updateStats(slot);
+    updateStats(right);
+    return right;
+}
+
+int SquadPool::rotateRight(int slot) {
+    int left = squads[slot].auraLeft;
+    int middle = squads[left].auraRight;
+    squads[slot].auraLeft = middle;
+    if(middle != -1) squads[middle].auraParent = slot;
+    replace(slot, left);
+    squads[left].auraRight = slot;
+    squads[slot].auraParent = left;
+    updateStats(slot);
+    updateStats(left);
+    return left;
+}
+
+// fix heights, weights and balance from slot up to the root
+void SquadPool::rebalance(int slot) {
+    while(slot != -1) {
+        updateStats(slot);
+        if(balance(slot) > 1) {
+            if(balance(squads[slot].auraLeft) < 0) rotateLeft(squads[slot].auraLeft);
+            slot = rotateRight(slot);
+        }
+        else if(balance(slot) < -1) {
+            if(balance(squads[slot].auraRight) > 0) rotateRight(squads[slot].auraRight);
+            slot = rotateLeft(slot);
+        }
+        slot = squads[slot].auraParent;
+    }
+}
+
+void SquadPool::auraLink(int slot) {
+    Squad& squad = squads[slot];
+    squad.auraLeft = -1;
+    squad.auraRight = -1;
+    squad.auraHeight = 0;
+    squad.auraWeight = 1;
+    if(auraRoot == -1) {
+        squad.auraParent = -1;
+        auraRoot = slot;
+        return;
+    }
+    int current = auraRoot;
+    while(true) {
+        int& next = auraLess(slot, current) ? squads[current].auraLeft : squads[current].auraRight;
+        if(next == -1) {
+            next = slot;
+            break;
+        }
+        current = next;
+    }
+    squad.auraParent = current;
+    rebalance(current);
+}
+
+void SquadPool::auraUnlink(int slot) {
+    Squad& squad = squads[slot];
+    int start;
+    if(squad.auraLeft == -1 || squad.auraRight == -1) {
+        start = squad.auraParent;
+        replace(slot, squad.auraLeft != -1 ? squad.auraLeft : squad.auraRight);
+    }
+    else {
+        // the successor takes slot's place in the tree
+        int successor = squad.auraRight;
+        while(squads[successor].auraLeft != -1) successor = squads[successor].auraLeft;
+        if(squads[successor].auraParent != slot) {
+            start = squads[successor].auraParent;
+            replace(successor, squads[successor].auraRight);
+            squads[successor].auraRight = squad.auraRight;
+            squads[squad.auraRight].auraParent = successor;
+        }
+        else {
+            start = successor;
+        }
+        replace(slot, successor);
+        squads[successor].auraLeft = squad.auraLeft;
+        squads[squad.auraLeft].auraParent = successor;
+    }
+    rebalance(start);
+}
+
+// balanced subtree over byAura[low..high] hung from parent, returns its root.
+// the halves differ by at most one squad, so so do the heights
+int SquadPool::buildAura(const int* byAura, int low, int high, int parent) {
+    if(low > high) return -1;
+    int middle = low + (high - low) / 2;
+    int slot = byAura[middle];
+    squads[slot].auraParent = parent;
+    squads[slot].auraLeft = buildAura(byAura, low, middle - 1, slot);
+    squads[slot].auraRight = buildAura(byAura, middle + 1, high, slot);
+    updateStats(slot);
+    return slot;
+}
+
+int SquadPool::find(int id) const {
+    for(int slot = buckets[bucketOf(id)]; slot != -1; slot = squads[slot].hashNext) {
+        if(squads[slot].id == id) return slot;
+    }
+    return -1;
+}
+
+int SquadPool::insert(int id) {
+    if(count >= (1 << bucketBits)) growBuckets();
+    int slot;
+    if(freeHead != -1) {
+        slot = freeHead;
+        freeHead = squads[slot].hashNext;
+        squads[slot] = Squad(id);
+    }
+    else {
+        if(used == capacity) grow();
+        slot = used++;
+        new (&squads[slot]) Squad(id);
+    }
+    hashLink(slot);
+    auraLink(slot);
+    count++;
+    return slot;
+}
+
+void SquadPool::reserve(int n) {
+    while(capacity - used < n) grow();
+    while((1 << bucketBits) < count + n) growBuckets();
+}
+
+void SquadPool::build(const int* ids, const int* auras, const int* byAura, int n) {
+    for(int slot = 0; slot < n; slot++) {
+        new (&squads[slot]) Squad(ids[slot]);
+        squads[slot].totalAura = auras[slot];
+        hashLink(slot);
+    }
+    used = n;
+    count = n;
+    freeHead = -1;
+    auraRoot = buildAura(byAura, 0, n - 1, -1);
+}
+
+void SquadPool::remove(int slot) {
+    hashUnlink(slot);
+    auraUnlink(slot);
+    squads[slot] = Squad(0);
+    squads[slot].hashNext = freeHead;
+    freeHead = slot;
+    count--;
+}
+
+void SquadPool::setAura(int slot, int aura) {
+    auraUnlink(slot);
+    squads[slot].totalAura = aura;
+    auraLink(slot);
+}
+
+int SquadPool::ith_by_aura(int i) const {
+    if(auraRoot == -1 || i < 1 || i > weight(auraRoot)) throw StatusType::FAILURE;
+    int current = auraRoot;
+    while(true) {
+        int leftWeight = weight(squads[current].auraLeft);
+        if(i == leftWeight + 1) return squads[current].id;
+        if(i <= leftWeight) current = squads[current].auraLeft;
+        else {
+            i -= leftWeight + 1;
+            current = squads[current].auraRight;
+        }
+    }
+}
+
+void SquadPool::swap(SquadPool& other) {
+    Squad* tempSquads = squads;
+    squads = other.squads;
+    other.squads = tempSquads;
+    int* tempBuckets = buckets;
+    buckets = other.buckets;
+    other.buckets = tempBuckets;
+    int temp;
+    temp = used; used = other.used; other.used = temp;
+    temp = capacity; capacity = other.capacity; other.capacity = temp;
+    temp = bucketBits; bucketBits = other.bucketBits; other.bucketBits = temp;
+    temp = count; count = other.count; other.count = temp;
+    temp = freeHead; freeHead = other.freeHead; other.freeHead = temp;
+    temp = auraRoot; auraRoot = other.auraRoot; other.auraRoot = temp;
+}
+
+void SquadPool::save(SnapshotWriter& out) const {
+    out.writeInt(used);
+    out.writeInt(count);
+    out.writeInt(bucketBits);
+    out.writeInt(freeHead);
+    out.writeInt(auraRoot);
+    out.write(squads, sizeof(Squad) * used);
+    out.write(buckets, sizeof(int) * (1 << bucketBits));
+}
+
+// a hook value: a slot below used, or -1 for none
+static bool isSlot(int hook, int used) {
+    return hook >= -1 && hook < used;
+}
+
+bool SquadPool::valid() const {
+    if(used < 0 || count < 0 || count > used || !isSlot(freeHead, used) || !isSlot(auraRoot, used) ||
+       (auraRoot == -1) != (count == 0)) return false;
+    int live = 0;
+    for(int slot = 0; slot < used; slot++) {
+        const Squad& squad = squads[slot];
+        if(squad.id < 0 || !isSlot(squad.hashNext, used) || !isSlot(squad.hashPrev, used) ||
+           !isSlot(squad.auraParent, used) || !isSlot(squad.auraLeft, used) ||
+           !isSlot(squad.auraRight, used)) return false;
+        if(squad.id > 0) live++;
+    }
+    if(live != count) return false;
+
+    // the free list holds every free slot once and ends, a cycle runs past
+    // the number of free slots
+    int free = 0;
+    for(int slot = freeHead; slot != -1; slot = squads[slot].hashNext) {
+        if(squads[slot].id != 0 || ++free > used - count) return false;
+    }
+    if(free != used - count) return false;
+
+    // every live squad sits once in the chain of its own bucket, linked both ways
+    int chained = 0;
+    for(int b = 0; b < (1 << bucketBits); b++) {
+        if(!isSlot(buckets[b], used)) return false;
+        int previous = -1;
+        for(int slot = buckets[b]; slot != -1; slot = squads[slot].hashNext) {
+            const Squad& squad = squads[slot];
+            if(squad.id == 0 || squad.hashPrev != previous || bucketOf(squad.id) != b || ++chained > count)
+                return false;
+            previous = slot;
+        }
+    }
+    if(chained != count) return false;
+
+    // the aura tree breadth first from the root: a child points back at its
+    // parent, so no squad is reached twice, and every live one is reached
+    if(auraRoot != -1 && (squads[auraRoot].id == 0 || squads[auraRoot].auraParent != -1)) return false;
+    std::unique_ptr<int[]> order(new int[count > 0 ? count : 1]);
+    int reached = 0;
+    if(auraRoot != -1) order[reached++] = auraRoot;
+    for(int k = 0; k < reached; k++) {
+        const Squad& squad = squads[order[k]];
+        if(squad.auraLeft != -1 && squad.auraLeft == squad.auraRight) return false;
+        int children[2] = {squad.auraLeft, squad.auraRight};
+        for(int child : children) {
+            if(child == -1) continue;
+            if(squads[child].id == 0 || squads[child].auraParent != order[k] || reached == count) return false;
+            order[reached++] = child;
+        }
+    }
+    if(reached != count) return false;
+    // children come after their parent in that order, so backwards every
+    // stored height and weight is checked against ones already checked
+    for(int k = reached - 1; k >= 0; k--) {
+        const Squad& squad = squads[order[k]];
+        int lh = height(squad.auraLeft);
+        int rh = height(squad.auraRight);
+        if(squad.auraHeight != 1 + (lh > rh ? lh : rh) || lh - rh > 1 || rh - lh > 1 ||
+           squad.auraWeight != 1 + weight(squad.auraLeft) + weight(squad.auraRight)) return false;
+    }
+    // and in order the squads go by (totalAura, id)
+    int slot = auraRoot;
+    while(slot != -1 && squads[slot].auraLeft != -1) slot = squads[slot].auraLeft;
+    for(int previous = -1; slot != -1; ) {
+        if(previous != -1 && !auraLess(previous, slot)) return false;
+        previous = slot;
+        if(squads[slot].auraRight != -1) {
+            slot = squads[slot].auraRight;
+            while(squads[slot].auraLeft != -1) slot = squads[slot].auraLeft;
+        }
+        else {
+            int child = slot;
+            slot = squads[slot].auraParent;
+            while(slot != -1 && squads[slot].auraRight == child) {
+                child = slot;
+                slot = squads[slot].auraParent;
+            }
+        }
+    }
+    return true;
+}
+
+void SquadPool::load(SnapshotReader& in) {
+    int newUsed = in.readInt();
+    int newCount = in.readInt();
+    int newBits = in.readInt();
+    int newFree = in.readInt();
+    int newRoot = in.readInt();
+    if(newUsed < 0 || newBits < 0 || newBits > 30 || (1 << newBits) < SQUAD_FIRST_BUCKETS)
+        throw StatusType::FAILURE;
+    size_t recordBytes = sizeof(Squad) * (size_t)newUsed;
+    size_t bucketBytes = sizeof(int) * ((size_t)1 << newBits);
+    if(recordBytes + bucketBytes > in.remaining()) throw StatusType::FAILURE;
+
+    // the arrays sit at any offset of the file: they are copied into a pool
+    // of their own, as bytes into raw memory as grow moves them, and only
+    // that copy is read and checked
+    SquadPool loaded;
+    int newCapacity = newUsed > SQUAD_FIRST_BUCKETS ? newUsed : SQUAD_FIRST_BUCKETS;
+    loaded.squads = static_cast<Squad*>(::operator new(sizeof(Squad) * newCapacity));
+    loaded.capacity = newCapacity;
+    int* newBuckets = new int[1 << newBits];
+    delete[] loaded.buckets;
+    loaded.buckets = newBuckets;
+    loaded.bucketBits = newBits;
+    memcpy(static_cast<void*>(loaded.squads), in.read(recordBytes), recordBytes);
+    memcpy(loaded.buckets, in.read(bucketBytes), bucketBytes);
+    loaded.used = newUsed;
+    loaded.count = newCount;
+    loaded.freeHead = newFree;
+    loaded.auraRoot = newRoot;
+    if(!loaded.valid()) throw StatusType::FAILURE;
+    swap(loaded);
+}
+
+Squad& SquadPool::operator[](int slot) {
+    return squads[slot];
+}
+
+const Squad& SquadPool::operator[](int slot) const {
+    return squads[slot];
+}
+
+int SquadPool::slots() const {
+    return used;
+}
+
+int SquadPool::size() const {
+    return count;
+}
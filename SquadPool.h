@@ -0,0 +1,94 @@
+#ifndef SQUADPOOL_H
+#define SQUADPOOL_H
+#define SQUAD_FIRST_BUCKETS 16
+
+#include "Squad.h"
+#include "Snapshot.h"
+
+// every squad of the system in one record. the records sit in one array and
+// each embeds the hooks of both orders it is kept in, so a squad costs one
+// slot and no node of its own:
+//  - by id: a chained hash table, buckets hold the first slot of a chain
+//  - by (totalAura, id): an AVL tree weighted by subtree size for ranks
+// removing a squad unlinks it in place from both, no search and no
+// allocation, and its slot is chained into a free list for the next insert.
+// the hooks are slot numbers, so the array may move when it grows: a Squad&
+// is only good until the next insert. kept contiguous rather than chunked
+// because the tree walks are bound by how fast a slot turns into an address
+class SquadPool {
+    Squad* squads;
+    int used;
+    int capacity;
+    int* buckets;
+    int bucketBits;
+    int count;
+    int freeHead;
+    int auraRoot;
+
+    SquadPool(const SquadPool&) = delete;
+    SquadPool& operator=(const SquadPool&) = delete;
+
+    void grow();
+    int bucketOf(int id) const;
+    void growBuckets();
+    void hashLink(int slot);
+    void hashUnlink(int slot);
+
+    bool auraLess(int a, int b) const;
+    int height(int slot) const;
+    int weight(int slot) const;
+    int balance(int slot) const;
+    void updateStats(int slot);
+    void replace(int oldSlot, int newSlot);
+    int rotateLeft(int slot);
+    int rotateRight(int slot);
+    void rebalance(int slot);
+    void auraLink(int slot);
+    void auraUnlink(int slot);
+    int buildAura(const int* byAura, int low, int high, int parent);
+
+public:
+    SquadPool();
+    ~SquadPool();
+
+    // slot of the squad with this id, -1 if there is none
+    int find(int id) const;
+    // add a squad with a new id and aura 0, returns its slot
+    int insert(int id);
+    // drop the squad in slot, never throws
+    void remove(int slot);
+    // move the squad to its new place in the aura order, never throws.
+    // totalAura must only change through here
+    void setAura(int slot, int aura);
+    // room for n more squads, so the next n inserts allocate nothing. the
+    // memory it got stays if it throws
+    void reserve(int n);
+    // fill a pool that never held a squad, reserved for n squads, at once:
+    // slot i gets squad ids[i] with auras[i], byAura lists the slots by
+    // (aura, id). the aura tree is built bottom-up around the middles of
+    // byAura, O(n) and no rotation. never throws
+    void build(const int* ids, const int* auras, const int* byAura, int n);
+    // id of the i-th squad by (totalAura, id), i from 1. throws FAILURE
+    // when out of range
+    int ith_by_aura(int i) const;
+
+    void swap(SquadPool& other);
+    // the records, hooks and buckets as they are. load replaces the pool's
+    // contents, throws FAILURE on a short stream or one that is not valid()
+    // and then leaves the pool as it was
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in);
+    // every hook in range and every walk ends: the free list holds exactly
+    // the free slots, each squad sits once in its bucket's chain, and the
+    // aura tree reaches every squad once, in order, with the stored heights
+    // and weights and no node out of balance. O(n)
+    bool valid() const;
+
+    Squad& operator[](int slot);
+    const Squad& operator[](int slot) const;
+    // slots in use or free, free ones hold a squad with id 0
+    int slots() const;
+    int size() const;
+};
+
+#endif //SQUADPOOL_H
@@ -0,0 +1,73 @@
+#include "TextReader.h"
+
+TextReader::TextReader(const char* path) : buffer(nullptr), file(nullptr), length(0), pos(0) {
+    buffer = new char[READER_BUFFER];
+    file = fopen(path, "rb");
+}
+
+TextReader::~TextReader() {
+    if(file) fclose(file);
+    delete[] buffer;
+}
+
+bool TextReader::isOpen() const {
+    return file != nullptr;
+}
+
+bool TextReader::refill() {
+    if(!file) return false;
+    length = (int)fread(buffer, 1, READER_BUFFER, file);
+    pos = 0;
+    return length > 0;
+}
+
+bool TextReader::atSpace() {
+    char c = buffer[pos];
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool TextReader::skipSpaces() {
+    while(true) {
+        if(pos == length && !refill()) return false;
+        if(!atSpace()) return true;
+        pos++;
+    }
+}
+
+bool TextReader::readInt(int& value) {
+    if(!skipSpaces()) return false;
+    bool negative = buffer[pos] == '-';
+    if(negative) pos++;
+    long long result = 0;
+    int digits = 0;
+    while(pos < length || refill()) {
+        if(atSpace()) break;
+        char c = buffer[pos];
+        if(c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+        if(result > 2147483648LL) return false;
+        digits++;
+        pos++;
+    }
+    if(digits == 0) return false;
+    if(negative) result = -result;
+    if(result > 2147483647LL) return false;
+    value = (int)result;
+    return true;
+}
+
+bool TextReader::readWord(char* word, int capacity) {
+    if(!skipSpaces()) return false;
+    int size = 0;
+    while(pos < length || refill()) {
+        if(atSpace()) break;
+        if(size + 1 >= capacity) return false;
+        word[size++] = buffer[pos++];
+    }
+    word[size] = 0;
+    return true;
+}
+
+bool TextReader::atEnd() {
+    return !skipSpaces();
+}
@@ -0,0 +1,37 @@
+#ifndef TEXTREADER_H
+#define TEXTREADER_H
+#define READER_BUFFER (1 << 16)
+
+#include <cstdio>
+
+// whitespace separated tokens of a text file, read in blocks through one
+// buffer instead of a stdio call per token
+class TextReader {
+    char* buffer;
+    FILE* file;
+    int length;
+    int pos;
+
+    TextReader(const TextReader&) = delete;
+    TextReader& operator=(const TextReader&) = delete;
+
+    bool refill();
+    // move to the next token, false at the end of the file
+    bool skipSpaces();
+    bool atSpace();
+
+public:
+    explicit TextReader(const char* path);
+    ~TextReader();
+
+    bool isOpen() const;
+    // false at the end of the file or when the token is not an int
+    bool readInt(int& value);
+    // the token into word with a terminating 0, false at the end of the file
+    // or when it needs more than capacity chars
+    bool readWord(char* word, int capacity);
+    // nothing but whitespace left
+    bool atEnd();
+};
+
+#endif //TEXTREADER_H
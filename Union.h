@@ -1,152 +1,570 @@
 
 #include "DynamicArray.h"
 #include "wet2util.h"
+#include "NenVector.h"
+#include "Prefetch.h"
+#include "Snapshot.h"
 #ifndef UNION_H
 #define UNION_H
 
 using namespace std;
 
-template <class T>
+// the fields of a node live in parallel arrays indexed by the node, split by
+// how often they are touched. a find only walks links and reads/writes the
+// fight and nen offsets, the squad level data is read at the root alone
+struct ULink {
+    int parent;
+    int size;
+    ULink() : parent(-1), size(0) {}
+    explicit ULink(int idx) : parent(idx), size(1) {}
+};
+
+// meaningful only while the node is a root
+struct USet {
+    int experience;
+    int lastChrono;
+    NenVector groupNen;
+    USet() : experience(0), lastChrono(0) {}
+    explicit USet(int idx) : experience(0), lastChrono(idx) {}
+};
+
+// path compression strategies for Union::find. each walks from idx to its
+// root, shortens the path and returns the root, adding the fight and nen
+// offsets met on the way (the root's own values excluded) into fightsAcc
+// and nenAcc. the offsets stay relative to whatever parent a node ends up with
+
+// two passes: sum the whole path, then hang every node directly on the root
+struct FullCompression {
+    static int find(DynamicArray<ULink>& links, DynamicArray<int>& fights,
+                    DynamicArray<NenVector>& selfNen, int idx, int& fightsAcc, NenVector& nenAcc) {
+        if(links[idx].parent == idx) return idx;
+        int next = idx; //given index
+        int tempP = 0; //parent
+        int sumFights = 0;
+        NenVector ability;
+        NenVector tempAbility;
+        int tempFights = 0;
+        while(links[idx].parent != idx) {
+            sumFights += fights[idx];
+            ability += selfNen[idx];
+            idx= links[idx].parent;
+        }
+        tempP = idx;
+        fightsAcc += sumFights;
+        nenAcc += ability;
+        idx = next;
+        while(links[idx].parent != idx) {
+            tempFights = fights[idx];
+            fights[idx] = sumFights;
+            sumFights-= tempFights;
+
+            tempAbility = selfNen[idx];
+            selfNen[idx] = ability;
+            ability-= tempAbility;
+
+            next = links[idx].parent;
+            links[idx].parent = tempP;
+            idx = next;
+        }
+        return tempP;
+    }
+};
+
+// one pass: every other node on the path skips to its grandparent
+struct PathHalving {
+    static int find(DynamicArray<ULink>& links, DynamicArray<int>& fights,
+                    DynamicArray<NenVector>& selfNen, int idx, int& fightsAcc, NenVector& nenAcc) {
+        while(links[idx].parent != idx) {
+            int parent = links[idx].parent;
+            int grand = links[parent].parent;
+            if(grand != parent) {
+                fights[idx] += fights[parent];
+                selfNen[idx] += selfNen[parent];
+                links[idx].parent = grand;
+            }
+            fightsAcc += fights[idx];
+            nenAcc += selfNen[idx];
+            idx = links[idx].parent;
+        }
+        return idx;
+    }
+};
+
+// one pass: every node on the path skips to its grandparent
+struct PathSplitting {
+    static int find(DynamicArray<ULink>& links, DynamicArray<int>& fights,
+                    DynamicArray<NenVector>& selfNen, int idx, int& fightsAcc, NenVector& nenAcc) {
+        while(links[idx].parent != idx) {
+            int parent = links[idx].parent;
+            int grand = links[parent].parent;
+            fightsAcc += fights[idx];
+            nenAcc += selfNen[idx];
+            if(grand != parent) {
+                fights[idx] += fights[parent];
+                selfNen[idx] += selfNen[parent];
+                links[idx].parent = grand;
+            }
+            idx = parent;
+        }
+        return idx;
+    }
+};
+
+// what a duel needs to know about a set, from a single find
+struct USummary {
+    int root;
+    int experience;
+};
+
+template <class T, class Compression = FullCompression>
 class Union {
-DynamicArray<T> unionF;
+DynamicArray<ULink> links;
+DynamicArray<int> fights;          // relative to the parent, absolute at a root
+DynamicArray<NenVector> selfNen;  // relative to the parent, absolute at a root
+DynamicArray<USet> sets;
+DynamicArray<T> values;
+int deadCount; // nodes of killed sets still stored
+
+void checkLoaded();
 
 public:
-    Union() = default;
+    Union() : deadCount(0) {}
     int makeSet(T value);
+    void reserve(int n);
+    template <class F>
+    int appendRun(int root, int n, F make);
     int find(int idx);
+    int find(int idx, int& fightsAcc, NenVector& nenAcc);
+    int find_const(int idx, int& fightsAcc, NenVector& nenAcc) const;
     int fightsHad(int idx);
+    int fightsHad(int idx) const;
     void addFight(int idx1,int idx2);
     int get_exp(int idx);
+    int get_exp(int idx) const;
     void add_exp(int idx, int exp);
     void kill(int idx);
     bool is_alive(int idx);
-    int lastChrono(int idx);
-    NenAbility partialAbility(int idx);
+    bool is_alive(int idx) const;
+    int lastChrono(int idx) const;
+    NenVector partialAbility(int idx);
+    NenVector partialAbility(int idx) const;
+    USummary resolve(int idx);
+    void prefetch(int idx) const;
     void combine(int idx1 , int idx2,int order);
+    void flatten_all();
+    int count() const;
+    int deadNodes() const;
+    template <class F>
+    unique_ptr<int[]> compact(int maxFrozen, F relocated);
+    void swap(Union& other);
+    // the arrays as they are, T must be trivially copyable. load fills an
+    // empty union and throws FAILURE on a short or inconsistent stream, it
+    // is meant for a scratch union that is dropped when it throws
+    void save(SnapshotWriter& out) const;
+    void load(SnapshotReader& in);
 };
 
 
-template <class T>
-int Union<T>::makeSet(T value) {
-    int idx = unionF.push_back(move(value));
-    unionF[idx].selfNen = unionF[idx].value->getNenAbility();
-    unionF[idx].lastChrono = idx;
+template <class T, class Compression>
+int Union<T, Compression>::makeSet(T value) {
+    int idx = links.getSize();
+    int initFights = value.getFights();
+    NenVector initNen = value.getNenAbility();
+    // all the arrays grow together, undo the pushes that made it if one fails
+    int pushed = 0;
+    try {
+        values.push_back(move(value));
+        pushed++;
+        fights.push_back(initFights);
+        pushed++;
+        selfNen.push_back(initNen);
+        pushed++;
+        sets.push_back(USet(idx));
+        pushed++;
+        links.push_back(ULink(idx));
+    }
+    catch(...) {
+        if(pushed > 3) sets.pop_back();
+        if(pushed > 2) selfNen.pop_back();
+        if(pushed > 1) fights.pop_back();
+        if(pushed > 0) values.pop_back();
+        throw;
+    }
     return idx;
 }
 
-template <class T>
-int Union<T>::find(int idx) {
-
-    if(unionF[idx].parent == idx) return idx;
-    int next = idx; //given index
-    int tempP = 0; //parent
-    int fights = 0;
-    NenAbility ability;
-    NenAbility tempAbility;
-    int tempFights = 0;
-    while(unionF[idx].parent != idx) {
-        fights +=unionF[idx].value->getFights();
-        ability += unionF[idx].selfNen;
-        idx= unionF[idx].parent;
-    }
-    fights +=unionF[idx].value->getFights();
-    tempP = idx;
-    idx = next;
-    while(unionF[idx].parent != idx) {
-        tempFights = unionF[idx].value->getFights();
-        unionF[idx].value->setFights(fights-unionF[tempP].value->getFights());
-        fights-= tempFights;
-
-        tempAbility = unionF[idx].selfNen;
-        unionF[idx].selfNen = ability;
-        ability-= tempAbility;
-
-        next = unionF[idx].parent;
-        unionF[idx].parent = tempP;
-        idx = next;
+// room for n more nodes in every array, the next n nodes allocate nothing
+template <class T, class Compression>
+void Union<T, Compression>::reserve(int n) {
+    values.reserve(n);
+    fights.reserve(n);
+    selfNen.reserve(n);
+    sets.reserve(n);
+    links.reserve(n);
+}
+
+// n new nodes joined to the set of root one after the other, the same as a
+// makeSet and a combine(root, new node, 0) each, with the arrays grown once
+// and no find. root must be a root, or -1 to make the first node one.
+// make(i) builds the i-th value. returns the index of the first node, the
+// rest follow it. nothing changes if it throws
+template <class T, class Compression>
+template <class F>
+int Union<T, Compression>::appendRun(int root, int n, F make) {
+    int first = links.getSize();
+    reserve(n);
+    for(int i = 0; i < n; i++) {
+        int idx = first + i;
+        T value = make(i);
+        int initFights = value.getFights();
+        NenVector initNen = value.getNenAbility();
+        values.push_back(move(value));
+        sets.push_back(USet(idx));
+        links.push_back(ULink(idx));
+        if(root == -1) {
+            fights.push_back(initFights);
+            selfNen.push_back(initNen);
+            root = idx;
+            continue;
+        }
+        // the first branch of combine, the set is never smaller than one node
+        USet& set = sets[root];
+        set.groupNen += initNen;
+        selfNen.push_back(set.groupNen);
+        fights.push_back(initFights - fights[root]);
+        set.lastChrono = idx;
+        links[root].size++;
+        links[idx].parent = root;
+    }
+    return first;
+}
+
+template <class T, class Compression>
+int Union<T, Compression>::find(int idx) {
+    int fightsAcc = 0;
+    NenVector nenAcc;
+    return Compression::find(links, fights, selfNen, idx, fightsAcc, nenAcc);
+}
+
+// root of idx, plus the offsets between idx and the root
+template <class T, class Compression>
+int Union<T, Compression>::find(int idx, int& fightsAcc, NenVector& nenAcc) {
+    fightsAcc = 0;
+    nenAcc = NenVector();
+    return Compression::find(links, fights, selfNen, idx, fightsAcc, nenAcc);
+}
+
+// same answer as find(idx, fightsAcc, nenAcc) but the path is only read,
+// nothing is compressed. the const queries below go through it so readers
+// never write to a shared union, compression is left to the writers' finds
+template <class T, class Compression>
+int Union<T, Compression>::find_const(int idx, int& fightsAcc, NenVector& nenAcc) const {
+    fightsAcc = 0;
+    nenAcc = NenVector();
+    while(links[idx].parent != idx) {
+        fightsAcc += fights[idx];
+        nenAcc += selfNen[idx];
+        idx = links[idx].parent;
     }
-    return tempP;
+    return idx;
 }
 
-template <class T>
-void Union<T>::combine(int idx1 , int idx2,int order) {
+template <class T, class Compression>
+void Union<T, Compression>::combine(int idx1 , int idx2,int order) {
     int rIdx1 = find(idx1);
     int rIdx2 = find(idx2);
     if(rIdx1 == rIdx2) throw StatusType::FAILURE;
-    else if(unionF[rIdx1].size >= unionF[rIdx2].size) {
-        unionF[rIdx1].groupNen +=unionF[rIdx2].selfNen;
-        unionF[rIdx2].selfNen =unionF[rIdx1].groupNen;
-        unionF[rIdx1].groupNen+=unionF[rIdx2].groupNen;
-        unionF[rIdx1].lastChrono = unionF[rIdx2].lastChrono;
+    USet& set1 = sets[rIdx1];
+    USet& set2 = sets[rIdx2];
+    if(links[rIdx1].size >= links[rIdx2].size) {
+        set1.groupNen +=selfNen[rIdx2];
+        selfNen[rIdx2] =set1.groupNen;
+        set1.groupNen+=set2.groupNen;
+        set1.lastChrono = set2.lastChrono;
 
-        unionF[rIdx2].value->setFights(unionF[rIdx2].value->getFights() - unionF[rIdx1].value->getFights());
+        fights[rIdx2] -= fights[rIdx1];
 
-        unionF[rIdx1].size += unionF[rIdx2].size;
-        unionF[rIdx1].experience+= unionF[rIdx2].experience;
-        unionF[rIdx2].parent = rIdx1;
+        links[rIdx1].size += links[rIdx2].size;
+        set1.experience+= set2.experience;
+        links[rIdx2].parent = rIdx1;
 
     }
     else {
 
         //called from force_join
         if(order == 1) {
-            unionF[rIdx2].selfNen+=unionF[rIdx1].selfNen+unionF[rIdx1].groupNen;
-            unionF[rIdx1].selfNen -= unionF[rIdx2].selfNen;
+            selfNen[rIdx2]+=selfNen[rIdx1]+set1.groupNen;
+            selfNen[rIdx1] -= selfNen[rIdx2];
         }
         else {
-            unionF[rIdx2].groupNen += unionF[rIdx2].selfNen;
-            unionF[rIdx1].selfNen = unionF[rIdx1].groupNen;
-            unionF[rIdx1].groupNen+= unionF[rIdx2].groupNen;
-            unionF[rIdx2].lastChrono = unionF[rIdx1].lastChrono;
+            set2.groupNen += selfNen[rIdx2];
+            selfNen[rIdx1] = set1.groupNen;
+            set1.groupNen+= set2.groupNen;
+            set2.lastChrono = set1.lastChrono;
         }
-        unionF[rIdx1].value->setFights(unionF[rIdx1].value->getFights() - unionF[rIdx2].value->getFights());
+        fights[rIdx1] -= fights[rIdx2];
 
-        unionF[rIdx2].size += unionF[rIdx1].size;
-        unionF[rIdx2].experience+= unionF[rIdx1].experience;
-        unionF[rIdx1].parent = rIdx2;
+        links[rIdx2].size += links[rIdx1].size;
+        set2.experience+= set1.experience;
+        links[rIdx1].parent = rIdx2;
     }
 }
 
-template <class T>
-int Union<T>::fightsHad(int idx) {
-    int p = find(idx);
-    if(p == idx) return unionF[p].value->getFights();
-    return unionF[p].value->getFights() + unionF[idx].value->getFights();
+template <class T, class Compression>
+int Union<T, Compression>::fightsHad(int idx) {
+    int fightsAcc;
+    NenVector nenAcc;
+    int p = find(idx, fightsAcc, nenAcc);
+    return fights[p] + fightsAcc;
+}
+template <class T, class Compression>
+int Union<T, Compression>::fightsHad(int idx) const {
+    int fightsAcc;
+    NenVector nenAcc;
+    int p = find_const(idx, fightsAcc, nenAcc);
+    return fights[p] + fightsAcc;
 }
-template<class T>
-int Union<T>::get_exp(int idx) {
+template<class T, class Compression>
+int Union<T, Compression>::get_exp(int idx) {
     int p = find(idx);
-    return unionF[p].experience ;
+    return sets[p].experience ;
+}
+template<class T, class Compression>
+int Union<T, Compression>::get_exp(int idx) const {
+    int fightsAcc;
+    NenVector nenAcc;
+    int p = find_const(idx, fightsAcc, nenAcc);
+    return sets[p].experience ;
 }
 
-template<class T>
-void Union<T>::add_exp(int idx, int exp) {
-    unionF[idx].experience += exp ;
+template<class T, class Compression>
+void Union<T, Compression>::add_exp(int idx, int exp) {
+    sets[idx].experience += exp ;
 }
 
-template<class T>
-NenAbility Union<T>::partialAbility(int idx) {
-    int p = find(idx);
-    if(p == idx) return unionF[p].selfNen;
-    return unionF[p].selfNen + unionF[idx].selfNen;
+template<class T, class Compression>
+NenVector Union<T, Compression>::partialAbility(int idx) {
+    int fightsAcc;
+    NenVector nenAcc;
+    int p = find(idx, fightsAcc, nenAcc);
+    return selfNen[p] + nenAcc;
 }
-template<class T>
-void Union<T>::kill(int idx) {
+template<class T, class Compression>
+NenVector Union<T, Compression>::partialAbility(int idx) const {
+    int fightsAcc;
+    NenVector nenAcc;
+    int p = find_const(idx, fightsAcc, nenAcc);
+    return selfNen[p] + nenAcc;
+}
+template<class T, class Compression>
+USummary Union<T, Compression>::resolve(int idx) {
+    USummary summary;
+    summary.root = find(idx);
+    summary.experience = sets[summary.root].experience;
+    return summary;
+}
+
+template<class T, class Compression>
+void Union<T, Compression>::prefetch(int idx) const {
+    HASH_PREFETCH(&links[idx]);
+    HASH_PREFETCH(&fights[idx]);
+    HASH_PREFETCH(&sets[idx]);
+}
+
+template<class T, class Compression>
+void Union<T, Compression>::kill(int idx) {
     if(idx == -1) throw StatusType::FAILURE;
-    unionF[idx].value->setAlive(false);
+    if(!values[idx].isAlive()) return;
+    values[idx].setAlive(false);
+    deadCount += links[idx].size;
 }
-template<class T>
-bool Union<T>::is_alive(int idx) {
+template<class T, class Compression>
+bool Union<T, Compression>::is_alive(int idx) {
     int p = find(idx);
-    return unionF[p].value->isAlive();
+    return values[p].isAlive();
 }
-template<class T>
-void Union<T>::addFight(int idx1, int idx2) {
-    unionF[idx1].value->setFights(unionF[idx1].value->getFights()+1);
-    unionF[idx2].value->setFights(unionF[idx2].value->getFights()+1);
+template<class T, class Compression>
+bool Union<T, Compression>::is_alive(int idx) const {
+    int fightsAcc;
+    NenVector nenAcc;
+    int p = find_const(idx, fightsAcc, nenAcc);
+    return values[p].isAlive();
+}
+template<class T, class Compression>
+void Union<T, Compression>::addFight(int idx1, int idx2) {
+    fights[idx1]++;
+    fights[idx2]++;
+}
+template <class T, class Compression>
+int Union<T, Compression>::lastChrono(int idx) const {
+    return sets[idx].lastChrono;
+}
+// hang every node directly on its root, whatever the find policy is.
+// a full compression of a path rewrites each node on it to its total offset
+// from the root, so a node is walked past at most once after its own pass
+// and the whole sweep is linear
+template <class T, class Compression>
+void Union<T, Compression>::flatten_all() {
+    int n = links.getSize();
+    for(int i = 0; i < n; i++) {
+        int parent = links[i].parent;
+        if(parent == i || links[parent].parent == parent) continue;
+        int fightsAcc = 0;
+        NenVector nenAcc;
+        FullCompression::find(links, fights, selfNen, i, fightsAcc, nenAcc);
+    }
+}
+
+template <class T, class Compression>
+int Union<T, Compression>::count() const {
+    return links.getSize();
+}
+template <class T, class Compression>
+int Union<T, Compression>::deadNodes() const {
+    return deadCount;
+}
+
+template <class T, class Compression>
+void Union<T, Compression>::swap(Union& other) {
+    links.swap(other.links);
+    fights.swap(other.fights);
+    selfNen.swap(other.selfNen);
+    sets.swap(other.sets);
+    values.swap(other.values);
+    int temp = deadCount;
+    deadCount = other.deadCount;
+    other.deadCount = temp;
 }
-template <class T>
-int Union<T>::lastChrono(int idx) {
-    return unionF[idx].lastChrono;
+
+template <class T, class Compression>
+void Union<T, Compression>::save(SnapshotWriter& out) const {
+    out.writeInt(links.getSize());
+    out.writeInt(deadCount);
+    links.for_each_run([&](const ULink* run, int count) { out.write(run, sizeof(ULink) * count); });
+    fights.for_each_run([&](const int* run, int count) { out.write(run, sizeof(int) * count); });
+    selfNen.for_each_run([&](const NenVector* run, int count) { out.write(run, sizeof(NenVector) * count); });
+    sets.for_each_run([&](const USet* run, int count) { out.write(run, sizeof(USet) * count); });
+    values.for_each_run([&](const T* run, int count) { out.write(run, sizeof(T) * count); });
+}
+
+template <class T, class Compression>
+void Union<T, Compression>::load(SnapshotReader& in) {
+    int n = in.readInt();
+    int dead = in.readInt();
+    if(n < 0 || dead < 0 || dead > n || links.getSize() != 0) throw StatusType::FAILURE;
+    size_t nodeBytes = sizeof(ULink) + sizeof(int) + sizeof(NenVector) + sizeof(USet) + sizeof(T);
+    if(nodeBytes * (size_t)n > in.remaining()) throw StatusType::FAILURE;
+    // the arrays sit at any offset of the file, they are copied into the
+    // union's own memory before a field of them is read
+    reserve(n);
+    links.append(in.read(sizeof(ULink) * (size_t)n), n);
+    fights.append(in.read(sizeof(int) * (size_t)n), n);
+    selfNen.append(in.read(sizeof(NenVector) * (size_t)n), n);
+    sets.append(in.read(sizeof(USet) * (size_t)n), n);
+    values.append(in.read(sizeof(T) * (size_t)n), n);
+    deadCount = dead;
+    checkLoaded();
+}
+
+// throws FAILURE unless the walks can trust the loaded links: every parent
+// chain ends at a root, a root's size is the number of nodes of its set, and
+// every node's lastChrono is a node of its own set (compact remaps it)
+template <class T, class Compression>
+void Union<T, Compression>::checkLoaded() {
+    int n = links.getSize();
+    unique_ptr<int[]> rootOf(new int[n]);
+    unique_ptr<int[]> members(new int[n]());
+    for(int i = 0; i < n; i++) rootOf[i] = -1;
+    // the nodes of the walk in progress hold -2, meeting one again is a cycle
+    for(int i = 0; i < n; i++) {
+        int idx = i;
+        while(rootOf[idx] == -1) {
+            int parent = links[idx].parent;
+            if(parent < 0 || parent >= n) throw StatusType::FAILURE;
+            if(parent == idx) {
+                rootOf[idx] = idx;
+                break;
+            }
+            rootOf[idx] = -2;
+            idx = parent;
+        }
+        if(rootOf[idx] == -2) throw StatusType::FAILURE;
+        int root = rootOf[idx];
+        for(int j = i; rootOf[j] == -2; j = links[j].parent) rootOf[j] = root;
+        members[root]++;
+    }
+    for(int i = 0; i < n; i++) {
+        int size = links[i].size;
+        if(rootOf[i] == i ? size != members[i] : size < 1 || size > n) throw StatusType::FAILURE;
+        int last = sets[i].lastChrono;
+        if(last < 0 || last >= n || rootOf[last] != rootOf[i]) throw StatusType::FAILURE;
+    }
+}
+
+// drop the nodes of every killed set and renumber the rest, keeping their order.
+// relocated(value, newIdx, fights) is called once per old node, newIdx is -1
+// for a dropped node and fights is then its final fight count. a killed set
+// with a node of more than maxFrozen fights is kept whole instead (the caller
+// could not store that count), it is not counted dead again.
+// returns the old index -> new index map (-1 for dropped nodes).
+// the arrays are rebuilt aside and swapped in at the end, so a failed
+// allocation leaves the union as it was
+template <class T, class Compression>
+template <class F>
+unique_ptr<int[]> Union<T, Compression>::compact(int maxFrozen, F relocated) {
+    int n = links.getSize();
+    unique_ptr<int[]> remap(new int[n]);
+    unique_ptr<int[]> frozen(new int[n]);
+    unique_ptr<bool[]> kept(new bool[n]());
+    // the root and final fights of every node first, then who stays
+    for(int i = 0; i < n; i++) {
+        int fightsAcc;
+        NenVector nenAcc;
+        int p = find(i, fightsAcc, nenAcc);
+        remap[i] = p;
+        frozen[i] = fights[p] + fightsAcc;
+        if(!values[p].isAlive() && frozen[i] > maxFrozen) kept[p] = true;
+    }
+    int live = 0;
+    for(int i = 0; i < n; i++) {
+        int p = remap[i];
+        if(values[p].isAlive() || kept[p]) {
+            remap[i] = live++;
+            frozen[i] = 0;
+        }
+        else remap[i] = -1;
+    }
+
+    // sets never split, so the parent and last member of a live node are live
+    DynamicArray<ULink> newLinks;
+    DynamicArray<int> newFights;
+    DynamicArray<NenVector> newSelfNen;
+    DynamicArray<USet> newSets;
+    DynamicArray<T> newValues;
+    for(int i = 0; i < n; i++) {
+        if(remap[i] == -1) continue;
+        ULink link = links[i];
+        link.parent = remap[link.parent];
+        USet set = sets[i];
+        set.lastChrono = remap[set.lastChrono];
+        newLinks.push_back(link);
+        newFights.push_back(fights[i]);
+        newSelfNen.push_back(selfNen[i]);
+        newSets.push_back(set);
+        newValues.push_back(values[i]);
+    }
+
+    links.swap(newLinks);
+    fights.swap(newFights);
+    selfNen.swap(newSelfNen);
+    sets.swap(newSets);
+    values.swap(newValues);
+    deadCount = 0;
+
+    // the old values now sit in newValues
+    for(int i = 0; i < n; i++) {
+        relocated(newValues[i], remap[i], frozen[i]);
+    }
+    return remap;
 }
 #endif //UNION_H
@@ -0,0 +1,270 @@
+#include <chrono>
+#include <cstring>
+#include <new>
+#include "Wal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAL_POSIX
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+// header: magic, version, byte order, lsn of the first record
+#define WAL_HEADER_SIZE (WAL_MAGIC_SIZE + 2 * sizeof(int) + sizeof(long long))
+
+// int arguments of a record of op, -1 for an unknown op
+static int walArgs(int op) {
+    switch(op) {
+        case WAL_ADD_SQUAD:
+        case WAL_REMOVE_SQUAD:
+            return 1;
+        case WAL_ADD_HUNTER:
+            return 4;
+        case WAL_SQUAD_DUEL:
+        case WAL_FORCE_JOIN:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+// FNV-1a over bytes
+static unsigned int walChecksum(const unsigned char* bytes, size_t size) {
+    unsigned int hash = 2166136261u;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static long long walMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+WalReader::WalReader(const char* path) : file(path), valid(false), first(0), end(0) {
+    if(!file.isOpen() || file.remaining() < WAL_HEADER_SIZE) return;
+    const void* magic = file.read(WAL_MAGIC_SIZE);
+    int version = file.readInt();
+    int order = file.readInt();
+    memcpy(&first, file.read(sizeof(first)), sizeof(first));
+    valid = memcmp(magic, WAL_MAGIC, WAL_MAGIC_SIZE) == 0 && version == WAL_VERSION &&
+            order == SNAPSHOT_BYTE_ORDER && first >= 1;
+    end = WAL_HEADER_SIZE;
+}
+
+bool WalReader::isOpen() const {
+    return file.isOpen();
+}
+
+bool WalReader::isValid() const {
+    return valid;
+}
+
+long long WalReader::firstLsn() const {
+    return first;
+}
+
+bool WalReader::next(WalRecord& record) {
+    if(!valid || file.remaining() < 1) return false;
+    const unsigned char* start = static_cast<const unsigned char*>(file.read(1));
+    int op = start[0];
+    int args = walArgs(op);
+    if(args == -1) return false;
+    // the op and nen bytes tell the size of the rest
+    size_t size = 1 + args * sizeof(int) + sizeof(unsigned int);
+    int nenByte = 0;
+    if(op == WAL_ADD_HUNTER) {
+        if(file.remaining() < 1) return false;
+        nenByte = *static_cast<const unsigned char*>(file.read(1));
+        if(nenByte == WAL_NEN_COUNTERS) size += NEN_TYPES * sizeof(int);
+        else if(nenByte >= NEN_TYPES) return false;
+        size++;
+    }
+    size_t read = (op == WAL_ADD_HUNTER) ? 2 : 1;
+    if(file.remaining() < size - read) return false;
+    file.read(size - read);
+    size_t body = size - sizeof(unsigned int);
+    unsigned int checksum;
+    memcpy(&checksum, start + body, sizeof(checksum));
+    if(checksum != walChecksum(start, body)) return false;
+
+    const unsigned char* at = start + read;
+    record.op = op;
+    record.nen = NenVector();
+    if(nenByte == WAL_NEN_COUNTERS) {
+        memcpy(record.nen.lanes, at, NEN_TYPES * sizeof(int));
+        at += NEN_TYPES * sizeof(int);
+    }
+    else if(op == WAL_ADD_HUNTER) record.nen.lanes[nenByte] = 1;
+    memcpy(record.args, at, args * sizeof(int));
+    end += size;
+    return true;
+}
+
+size_t WalReader::validBytes() const {
+    return end;
+}
+
+Wal::Wal() : file(nullptr), buffer(nullptr), buffered(0), pending(0), appendedLsn(0),
+             syncedLsn(0), groupSize(1), windowMicros(0), firstPendingMicros(0), failed(false) {
+    buffer = new char[WAL_BUFFER];
+}
+
+Wal::~Wal() {
+    if(file) {
+        flush();
+        fclose(file);
+    }
+    delete[] buffer;
+}
+
+StatusType Wal::open(const char* path, long long lsn, int group, int window) {
+    if(file) return StatusType::FAILURE;
+    size_t keep = 0;
+    bool exists;
+    {
+        WalReader log(path);
+        exists = log.isOpen();
+        if(exists) {
+            if(!log.isValid()) return StatusType::FAILURE;
+            long long last = log.firstLsn() - 1;
+            WalRecord record;
+            while(log.next(record)) last++;
+            if(last != lsn) return StatusType::FAILURE;
+            keep = log.validBytes();
+        }
+    }
+
+    if(exists) {
+        // carry on after the last whole record, a torn tail is cut off
+        FILE* existing = fopen(path, "r+b");
+        if(!existing) return StatusType::FAILURE;
+        bool ready = fseek(existing, 0, SEEK_END) == 0;
+#ifdef WAL_POSIX
+        if(ready && (size_t)ftell(existing) != keep) {
+            ready = ftruncate(fileno(existing), (off_t)keep) == 0 && fseek(existing, 0, SEEK_END) == 0;
+        }
+#else
+        if(ready && (size_t)ftell(existing) != keep) ready = false;
+#endif
+        if(!ready) {
+            fclose(existing);
+            return StatusType::FAILURE;
+        }
+        file = existing;
+    }
+    else {
+        FILE* created = fopen(path, "wb");
+        if(!created) return StatusType::FAILURE;
+        int version = WAL_VERSION;
+        int order = SNAPSHOT_BYTE_ORDER;
+        long long first = lsn + 1;
+        bool ready = fwrite(WAL_MAGIC, 1, WAL_MAGIC_SIZE, created) == WAL_MAGIC_SIZE &&
+                     fwrite(&version, sizeof(version), 1, created) == 1 &&
+                     fwrite(&order, sizeof(order), 1, created) == 1 &&
+                     fwrite(&first, sizeof(first), 1, created) == 1 && fflush(created) == 0;
+#ifdef WAL_POSIX
+        ready = ready && fsync(fileno(created)) == 0;
+#endif
+        if(!ready) {
+            fclose(created);
+            remove(path);
+            return StatusType::FAILURE;
+        }
+        file = created;
+    }
+    buffered = 0;
+    pending = 0;
+    appendedLsn = lsn;
+    syncedLsn = lsn;
+    groupSize = group;
+    windowMicros = window;
+    failed = false;
+    return StatusType::SUCCESS;
+}
+
+bool Wal::healthy() const {
+    return !failed;
+}
+
+// write the buffered records and fsync them, one group
+void Wal::flush() {
+    if(pending == 0 || failed) return;
+    if(fwrite(buffer, 1, buffered, file) != (size_t)buffered || fflush(file) != 0) failed = true;
+#ifdef WAL_POSIX
+    if(!failed && fsync(fileno(file)) != 0) failed = true;
+#endif
+    if(failed) return;
+    buffered = 0;
+    pending = 0;
+    syncedLsn = appendedLsn;
+}
+
+// the lane of a one-type ability, WAL_NEN_COUNTERS for any other
+static int walNenByte(const NenVector& nen) {
+    int lane = -1;
+    for(int j = 0; j < NEN_TYPES; j++) {
+        if(nen.lanes[j] == 0) continue;
+        if(nen.lanes[j] != 1 || lane != -1) return WAL_NEN_COUNTERS;
+        lane = j;
+    }
+    return lane == -1 ? WAL_NEN_COUNTERS : lane;
+}
+
+bool Wal::append(int op, const int* args, const NenVector* nen) {
+    if(failed) return false;
+    if(WAL_BUFFER - buffered < WAL_RECORD_MAX) flush();
+    if(failed) return false;
+    unsigned char* start = reinterpret_cast<unsigned char*>(buffer + buffered);
+    unsigned char* at = start;
+    *at++ = (unsigned char)op;
+    if(op == WAL_ADD_HUNTER) {
+        int nenByte = walNenByte(*nen);
+        *at++ = (unsigned char)nenByte;
+        if(nenByte == WAL_NEN_COUNTERS) {
+            memcpy(at, nen->lanes, NEN_TYPES * sizeof(int));
+            at += NEN_TYPES * sizeof(int);
+        }
+    }
+    size_t argBytes = walArgs(op) * sizeof(int);
+    memcpy(at, args, argBytes);
+    at += argBytes;
+    unsigned int checksum = walChecksum(start, at - start);
+    memcpy(at, &checksum, sizeof(checksum));
+    at += sizeof(checksum);
+    buffered += (int)(at - start);
+    appendedLsn++;
+
+    pending++;
+    if(pending >= groupSize) {
+        flush();
+        return !failed;
+    }
+    // the clock is only read under a window
+    if(windowMicros > 0) {
+        long long now = walMicros();
+        if(pending == 1) firstPendingMicros = now;
+        else if(now - firstPendingMicros >= windowMicros) flush();
+    }
+    return !failed;
+}
+
+StatusType Wal::sync() {
+    flush();
+    return failed ? StatusType::FAILURE : StatusType::SUCCESS;
+}
+
+StatusType Wal::poll() {
+    if(pending > 0 && windowMicros > 0 && walMicros() - firstPendingMicros >= windowMicros) flush();
+    return failed ? StatusType::FAILURE : StatusType::SUCCESS;
+}
+
+long long Wal::lastLsn() const {
+    return appendedLsn;
+}
+
+long long Wal::durableLsn() const {
+    return syncedLsn;
+}
@@ -0,0 +1,114 @@
+#ifndef WAL_H
+#define WAL_H
+#define WAL_MAGIC "HUNTWAL_"
+#define WAL_MAGIC_SIZE 8
+#define WAL_VERSION 1
+#define WAL_BUFFER (1 << 16)
+#define WAL_RECORD_MAX 64
+// the nen byte of an add_hunter whose ability is not one type: its
+// NEN_TYPES counters follow as ints
+#define WAL_NEN_COUNTERS 0xFF
+
+// the logged commands, the first byte of a record
+#define WAL_ADD_SQUAD 1
+#define WAL_REMOVE_SQUAD 2
+#define WAL_ADD_HUNTER 3
+#define WAL_SQUAD_DUEL 4
+#define WAL_FORCE_JOIN 5
+
+#include <cstdio>
+#include <cstddef>
+#include "wet2util.h"
+#include "NenVector.h"
+#include "Snapshot.h"
+
+// a write-ahead log of the commands that changed a Huntech. the file is a
+// header (magic, version, byte order and the lsn of its first record)
+// followed by records of
+//   <op byte> [<nen byte> for add_hunter] <the int arguments> <checksum>
+// where the nen byte is the lane of a one-type ability, or WAL_NEN_COUNTERS
+// and then the counters
+// a record's lsn is its place in the file after the first one. the checksum
+// (FNV-1a of the record's other bytes) finds the torn tail a crash may leave,
+// the log ends at the first record that is short or does not match it
+
+// one record as read back. add_hunter has hunterId, squadId, aura and
+// fightsHad in args and its ability in nen, the duels and joins the two
+// squads, the rest one squad
+struct WalRecord {
+    int op;
+    int args[4];
+    NenVector nen;
+};
+
+// the records of a log file in order, the file is mapped or read whole
+class WalReader {
+    SnapshotReader file;
+    bool valid;
+    long long first;
+    size_t end;
+
+    WalReader(const WalReader&) = delete;
+    WalReader& operator=(const WalReader&) = delete;
+
+public:
+    explicit WalReader(const char* path);
+
+    // the file exists
+    bool isOpen() const;
+    // it starts with a header this build writes
+    bool isValid() const;
+    long long firstLsn() const;
+    // the next whole record, false at the end of the log
+    bool next(WalRecord& record);
+    // bytes up to the end of the last record next returned
+    size_t validBytes() const;
+};
+
+// appends records and makes them durable a group at a time: the buffered
+// records are written and fsynced once groupSize of them wait, or once the
+// oldest has waited windowMicros, or on sync. a record is durable once
+// durableLsn reaches it. the window is only checked by append and poll,
+// there is no thread to watch it: on a quiet log the owner must call poll
+// (or sync) every so often, or the last group waits for the next record.
+// a failed write or fsync breaks the log for good
+class Wal {
+    FILE* file;
+    char* buffer;
+    int buffered;
+    int pending;
+    long long appendedLsn;
+    long long syncedLsn;
+    int groupSize;
+    long long windowMicros;
+    long long firstPendingMicros;
+    bool failed;
+
+    Wal(const Wal&) = delete;
+    Wal& operator=(const Wal&) = delete;
+
+    void flush();
+
+public:
+    Wal();
+    ~Wal();
+
+    // log to path from lsn + 1 on. a new file gets a header, an existing one
+    // must end at lsn once its torn tail is cut off, else FAILURE
+    StatusType open(const char* path, long long lsn, int groupSize, int windowMicros);
+    // false once a write or fsync failed
+    bool healthy() const;
+    // log the command with lsn lastLsn() + 1. args and nen as in WalRecord,
+    // nen only read for add_hunter. false if the log is broken, before or by
+    // this record, and then the record may be lost
+    bool append(int op, const int* args, const NenVector* nen);
+    // write and fsync whatever waits
+    StatusType sync();
+    // sync if the oldest waiting record is past the window, else nothing.
+    // reads the clock only while records wait under a window
+    StatusType poll();
+    long long lastLsn() const;
+    long long durableLsn() const;
+};
+
+#endif //WAL_H
@@ -0,0 +1,60 @@
+// AdaptiveIdIndex against DoubleHashTable on three id streams: dense ids in
+// order, the same ids shuffled, and ids scattered over 1..2e9. each run
+// inserts n ids and then does 5n random finds of them
+//   AdaptiveIdIndexBench [n]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "AdaptiveIdIndex.h"
+#include "DoubleHashTable.h"
+
+static unsigned int state = 1;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+template <class Index>
+static void run(const char* name, const int* ids, int n) {
+    state = 1;
+    auto start = std::chrono::steady_clock::now();
+    Index index;
+    for (int i = 0; i < n; i++) index.insert(ids[i], i);
+    double insertTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (long long q = 0; q < 5LL * n; q++) sum += index.find(ids[nextRandom() % (unsigned int)n]);
+    double findTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-16s insert %.3fs, find %.3fs (checksum %lld)\n", name, insertTime, findTime, sum);
+}
+
+static void stream(const char* title, const int* ids, int n) {
+    printf("%s\n", title);
+    run<AdaptiveIdIndex<int, int>>("adaptive", ids, n);
+    run<DoubleHashTable<int, int>>("double hashing", ids, n);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 4000000;
+    int* ids = new int[n];
+
+    for (int i = 0; i < n; i++) ids[i] = i + 1;
+    stream("dense ids 1..n in order", ids, n);
+
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(nextRandom() % (unsigned int)(i + 1));
+        int temp = ids[i];
+        ids[i] = ids[j];
+        ids[j] = temp;
+    }
+    stream("dense ids 1..n shuffled", ids, n);
+
+    for (int i = 0; i < n; i++) ids[i] = 1 + (int)((unsigned int)i * 2654435761u % 2000000000u);
+    stream("ids scattered over 1..2e9", ids, n);
+
+    delete[] ids;
+    return 0;
+}
@@ -0,0 +1,70 @@
+// read scaling of ConcurrentHashTable: 1..N reader threads run finds on a
+// filled table for a fixed time while one writer keeps inserting and
+// removing (and so resizing). prints the finds per second of each run
+//   ConcurrentHashTableBench [max readers] [keys] [milliseconds per run]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "ConcurrentHashTable.h"
+
+static void reader(const ConcurrentHashTable<int, int>& table, const std::atomic<bool>& done,
+                   int keys, int seed, std::atomic<long long>& total) {
+    unsigned int state = 17 + seed;
+    long long finds = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 256; i++) {
+            state = state * 1103515245u + 12345u;
+            table.find(1 + (int)((state >> 8) % (unsigned int)keys));
+        }
+        finds += 256;
+    }
+    total += finds;
+}
+
+static void writer(ConcurrentHashTable<int, int>& table, const std::atomic<bool>& done,
+                   int keys, std::atomic<long long>& total) {
+    long long writes = 0;
+    int next = keys + 1;
+    // keys past the filled range live for keys / 2 inserts, then go
+    while (!done.load(std::memory_order_relaxed)) {
+        table.insert(next, next);
+        int old = next - keys / 2;
+        if (old > keys) table.remove(old);
+        next++;
+        writes += 2;
+    }
+    total += writes;
+}
+
+int main(int argc, char** argv) {
+    int hardware = (int)std::thread::hardware_concurrency();
+    int maxReaders = argc > 1 ? atoi(argv[1]) : (hardware > 1 ? hardware : 4);
+    int keys = argc > 2 ? atoi(argv[2]) : 1000000;
+    int millis = argc > 3 ? atoi(argv[3]) : 1000;
+    printf("%d hardware threads, %d keys, %d ms per run\n", hardware, keys, millis);
+
+    for (int readers = 1; readers <= maxReaders; readers *= 2) {
+        ConcurrentHashTable<int, int> table;
+        for (int k = 1; k <= keys; k++) table.insert(k, k);
+        std::atomic<bool> done(false);
+        std::atomic<long long> finds(0);
+        std::atomic<long long> writes(0);
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; r++) {
+            threads.emplace_back(reader, std::cref(table), std::cref(done), keys, r, std::ref(finds));
+        }
+        threads.emplace_back(writer, std::ref(table), std::cref(done), keys, std::ref(writes));
+        std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+        done.store(true);
+        for (std::thread& t : threads) t.join();
+        table.reclaim();
+        double seconds = millis / 1000.0;
+        printf("%2d readers + 1 writer: %8.2f M finds/s (%.2f M per reader), %.2f M writes/s\n",
+               readers, finds.load() / seconds / 1e6, finds.load() / seconds / 1e6 / readers,
+               writes.load() / seconds / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// thread scaling of ConcurrentUnion: 1..N threads run for a fixed time on
+// their own block of a prebuilt forest, mostly fightsHad queries (the
+// lock-free path, splitting as it goes) with one combine or fight in
+// every sixteen operations. prints the operations per second of each run
+// and how many records were retired, the union is reclaimed between runs
+//   ConcurrentUnionBench [max threads] [nodes per thread] [milliseconds per run]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "ConcurrentUnion.h"
+#include "Hunter.h"
+
+static unsigned int nextRandom(unsigned int& state) {
+    state = state * 1103515245u + 12345u;
+    return state >> 8;
+}
+
+static void worker(ConcurrentUnion<Hunter>& sets, const std::atomic<bool>& done,
+                   int first, int block, int seed, std::atomic<long long>& total) {
+    unsigned int state = 17 + seed;
+    long long ops = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 256; i++) {
+            int a = first + (int)(nextRandom(state) % (unsigned int)block);
+            if (i % 16) {
+                sets.fightsHad(a);
+                continue;
+            }
+            int b = first + (int)(nextRandom(state) % (unsigned int)block);
+            if (sets.find(a) != sets.find(b)) sets.combine(a, b, 0);
+            else sets.addFight(a, b);
+        }
+        ops += 256;
+    }
+    total += ops;
+}
+
+int main(int argc, char** argv) {
+    int hardware = (int)std::thread::hardware_concurrency();
+    int maxThreads = argc > 1 ? atoi(argv[1]) : (hardware > 1 ? hardware : 4);
+    int block = argc > 2 ? atoi(argv[2]) : 200000;
+    int millis = argc > 3 ? atoi(argv[3]) : 1000;
+    printf("%d hardware threads, %d nodes per thread, %d ms per run\n", hardware, block, millis);
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ConcurrentUnion<Hunter> sets;
+        for (int idx = 0; idx < threads * block; idx++) sets.makeSet(Hunter(idx + 1, NenVector(), 1, 0));
+        // chains of eight, so the first queries have paths to split
+        for (int idx = 0; idx < threads * block; idx += 8) {
+            for (int k = 1; k < 8 && idx + k < threads * block; k++) sets.combine(idx + k, idx + k - 1, 1);
+        }
+        sets.reclaim();
+        std::atomic<bool> done(false);
+        std::atomic<long long> ops(0);
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back(worker, std::ref(sets), std::cref(done), t * block, block, t, std::ref(ops));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+        done.store(true);
+        for (std::thread& t : pool) t.join();
+        int retired = sets.retiredRecords();
+        sets.reclaim();
+        double seconds = millis / 1000.0;
+        printf("%2d threads: %8.2f M ops/s (%.2f M per thread), %d records retired\n",
+               threads, ops.load() / seconds / 1e6, ops.load() / seconds / 1e6 / threads, retired);
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+// find calls and time per duel, resolving each side's set the old way
+// (get_exp, then partialAbility of its last member) against one resolve.
+// the finds are counted by a policy that forwards to FullCompression. the
+// duels are random pairs over squads of hunters joined as add_hunter joins
+// them, the winner by experience gains it at its root. then squad_duel
+// through Huntech on the same shape
+//   DuelResolveBench [squads] [hunters per squad] [duels]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Hunter.h"
+#include "Union.h"
+#include "Huntech26a2.h"
+
+static long long findCalls = 0;
+// the old path's Nen reads land here so they are not optimized away
+static long long nenSink = 0;
+
+struct CountingFind {
+    static int find(DynamicArray<ULink>& links, DynamicArray<int>& fights,
+                    DynamicArray<NenVector>& selfNen, int idx, int& fightsAcc, NenVector& nenAcc) {
+        findCalls++;
+        return FullCompression::find(links, fights, selfNen, idx, fightsAcc, nenAcc);
+    }
+};
+
+typedef Union<Hunter, CountingFind> Sets;
+
+static unsigned int state = 1;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static NenVector typeVector(int i) {
+    NenVector nen;
+    nen.lanes[i % NEN_TYPES] = 1;
+    return nen;
+}
+
+// squad s starts at node s * size, head[s] is the node its duels go through
+static void build(Sets& sets, int* head, int squads, int size) {
+    for (int s = 0; s < squads; s++) {
+        head[s] = s * size;
+        for (int k = 0; k < size; k++) {
+            int idx = sets.makeSet(Hunter(s * size + k + 1, typeVector(k), 1, 0));
+            if (k > 0) sets.combine(head[s], idx, 0);
+        }
+    }
+}
+
+// one duel, each side read as squad_duel read it before resolve and after
+template <bool Resolve>
+static int fight(Sets& sets, const int* head, int a, int b) {
+    int exp1, exp2;
+    int root1, root2;
+    if (Resolve) {
+        USummary side1 = sets.resolve(head[a]);
+        USummary side2 = sets.resolve(head[b]);
+        root1 = side1.root;
+        root2 = side2.root;
+        exp1 = side1.experience;
+        exp2 = side2.experience;
+    }
+    else {
+        root1 = head[a];
+        root2 = head[b];
+        exp1 = sets.get_exp(root1);
+        exp2 = sets.get_exp(root2);
+        nenSink += sets.partialAbility(sets.lastChrono(root1)).effective();
+        nenSink += sets.partialAbility(sets.lastChrono(root2)).effective();
+    }
+    sets.addFight(root1, root2);
+    if (exp1 >= exp2) {
+        sets.add_exp(sets.find(root1), 3);
+        return 1;
+    }
+    sets.add_exp(sets.find(root2), 3);
+    return 3;
+}
+
+template <bool Resolve>
+static void run(const char* name, int squads, int size, int duels) {
+    Sets sets;
+    int* head = new int[squads];
+    build(sets, head, squads, size);
+    state = 3;
+    findCalls = 0;
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < duels; i++) {
+        int a = (int)(nextRandom() % (unsigned int)squads);
+        int b = (int)(nextRandom() % (unsigned int)squads);
+        if (a != b) sum += fight<Resolve>(sets, head, a, b);
+    }
+    double seconds = since(start);
+    printf("  %-28s %.2f finds per duel, %.0f ns per duel (checksum %lld)\n",
+           name, (double)findCalls / duels, seconds * 1e9 / duels, sum);
+    delete[] head;
+}
+
+int main(int argc, char** argv) {
+    int squads = argc > 1 ? atoi(argv[1]) : 20000;
+    int size = argc > 2 ? atoi(argv[2]) : 50;
+    int duels = argc > 3 ? atoi(argv[3]) : 2000000;
+    printf("%d squads of %d hunters, %d duels\n", squads, size, duels);
+    run<false>("get_exp and partialAbility", squads, size, duels);
+    run<true>("resolve", squads, size, duels);
+
+    Huntech system;
+    for (int s = 1; s <= squads; s++) {
+        system.add_squad(s);
+        for (int k = 0; k < size; k++) system.add_hunter((s - 1) * size + k + 1, s, NenAbility("Enhancer"), 1 + k, 0);
+    }
+    state = 3;
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < duels; i++) {
+        int a = 1 + (int)(nextRandom() % (unsigned int)squads);
+        int b = 1 + (int)(nextRandom() % (unsigned int)squads);
+        output_t<int> result = system.squad_duel(a, b);
+        if (result.status() == StatusType::SUCCESS) sum += result.ans();
+    }
+    printf("  %-28s %.0f ns per duel (checksum %lld)\n", "Huntech::squad_duel", since(start) * 1e9 / duels, sum);
+    return 0;
+}
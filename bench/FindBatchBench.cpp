@@ -0,0 +1,115 @@
+// find_batch against one find at a time, on a table well above the last
+// level cache: n random keys, then the same random queries (a tenth of them
+// misses) both ways. then the same for hunter fights through Huntech, with
+// ids scattered so the index is hashed
+//   FindBatchBench [keys] [queries] [hunters]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "DoubleHashTable.h"
+#include "Huntech26a2.h"
+
+static unsigned int state = 1;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// query i is key[random] + 1 for a tenth of them, every key being even
+static void makeQueries(const int* keys, int n, int* queries, int count) {
+    state = 99;
+    for (int i = 0; i < count; i++) {
+        unsigned int r = nextRandom();
+        queries[i] = keys[r % (unsigned int)n] + (r % 10 == 0 ? 1 : 0);
+    }
+}
+
+static void table(int n, int count) {
+    int* keys = new int[n];
+    int* queries = new int[count];
+    int* out = new int[count];
+    state = 1;
+    for (int i = 0; i < n; i++) keys[i] = (int)(nextRandom() & 0x7ffffffe);
+    DoubleHashTable<int, int> hashed;
+    hashed.reserve(n);
+    for (int i = 0; i < n; i++) hashed.insert(keys[i], i);
+    makeQueries(keys, n, queries, count);
+
+    long long loopSum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) loopSum += hashed.find(queries[i]);
+    double loopTime = since(start);
+
+    long long batchSum = 0;
+    start = std::chrono::steady_clock::now();
+    hashed.find_batch(queries, out, count);
+    for (int i = 0; i < count; i++) batchSum += out[i];
+    double batchTime = since(start);
+    printf("DoubleHashTable, %d keys, %d queries: find %.2fs, find_batch %.2fs\n", n, count, loopTime, batchTime);
+    if (loopSum != batchSum) {
+        printf("the answers disagree\n");
+        exit(1);
+    }
+    delete[] keys;
+    delete[] queries;
+    delete[] out;
+}
+
+static void huntech(int n, int count) {
+    int* ids = new int[n];
+    int* queries = new int[count];
+    int* fights = new int[count];
+    StatusType* results = new StatusType[count];
+    Huntech system;
+    NenAbility nen("Enhancer");
+    const int squads = 10000;
+    for (int s = 1; s <= squads; s++) system.add_squad(s);
+    state = 5;
+    for (int i = 0; i < n; i++) {
+        ids[i] = 2 + (int)(nextRandom() & 0x7ffffffe);
+        if (system.add_hunter(ids[i], 1 + i % squads, nen, 1, i % 100) != StatusType::SUCCESS) ids[i] = ids[0];
+    }
+    makeQueries(ids, n, queries, count);
+
+    long long loopSum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) {
+        output_t<int> result = system.get_hunter_fights_number(queries[i]);
+        if (result.status() == StatusType::SUCCESS) loopSum += result.ans();
+    }
+    double loopTime = since(start);
+
+    long long batchSum = 0;
+    start = std::chrono::steady_clock::now();
+    system.get_hunters_fights_number(queries, count, fights, results);
+    for (int i = 0; i < count; i++) {
+        if (results[i] == StatusType::SUCCESS) batchSum += fights[i];
+    }
+    double batchTime = since(start);
+    printf("Huntech, %d hunters, %d queries: get_hunter_fights_number %.2fs, get_hunters_fights_number %.2fs\n",
+           n, count, loopTime, batchTime);
+    if (loopSum != batchSum) {
+        printf("the answers disagree\n");
+        exit(1);
+    }
+    delete[] ids;
+    delete[] queries;
+    delete[] fights;
+    delete[] results;
+}
+
+int main(int argc, char** argv) {
+    int keys = argc > 1 ? atoi(argv[1]) : 16000000;
+    int queries = argc > 2 ? atoi(argv[2]) : 20000000;
+    int hunters = argc > 3 ? atoi(argv[3]) : 4000000;
+    table(keys, queries);
+    huntech(hunters, queries);
+    return 0;
+}
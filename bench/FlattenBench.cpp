@@ -0,0 +1,73 @@
+// query latency after a wave of force_joins, with and without
+// Huntech::flatten. single-hunter squads are merged pairwise by force_join
+// until one squad is left, then every hunter's fights are read in a random
+// order, twice
+//   FlattenBench [log2 squads] [runs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Huntech26a2.h"
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// squad and hunter i have aura i, so the later block of each pair is the
+// stronger one and forces the earlier one. a block survives as the squad of
+// its last id, the trees end log2(n) deep
+static void build(Huntech& system, int n) {
+    NenAbility nen("Enhancer");
+    for (int i = 1; i <= n; i++) {
+        system.add_squad(i);
+        system.add_hunter(i, i, nen, i, i % 7);
+    }
+    for (int block = 1; block < n; block *= 2) {
+        for (int first = 1; first + block <= n; first += 2 * block) {
+            if (system.force_join(first + 2 * block - 1, first + block - 1) != StatusType::SUCCESS) {
+                printf("force_join failed\n");
+                exit(1);
+            }
+        }
+    }
+}
+
+static double pass(Huntech& system, const int* order, int n, long long& sum) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) sum += system.get_hunter_fights_number(order[i]).ans();
+    return since(start) * 1e9 / n;
+}
+
+int main(int argc, char** argv) {
+    int levels = argc > 1 ? atoi(argv[1]) : 15;
+    int runs = argc > 2 ? atoi(argv[2]) : 6;
+    int n = 1 << levels;
+    int* order = new int[n];
+    srand(9);
+    printf("%d squads, %d levels, ns per query\n", n, levels);
+    for (int run = 0; run < runs; run++) {
+        for (int i = 0; i < n; i++) order[i] = i + 1;
+        for (int i = n - 1; i > 0; i--) {
+            int j = rand() % (i + 1);
+            int temp = order[i];
+            order[i] = order[j];
+            order[j] = temp;
+        }
+        long long sum = 0;
+        Huntech plain;
+        build(plain, n);
+        double plainFirst = pass(plain, order, n, sum);
+        double plainSecond = pass(plain, order, n, sum);
+
+        Huntech flat;
+        build(flat, n);
+        auto start = std::chrono::steady_clock::now();
+        flat.flatten();
+        double flattenTime = since(start);
+        double flatFirst = pass(flat, order, n, sum);
+        double flatSecond = pass(flat, order, n, sum);
+        printf("run %d: no flatten %.0f / %.0f, flatten (%.2f ms) then %.0f / %.0f (checksum %lld)\n",
+               run, plainFirst, plainSecond, flattenTime * 1e3, flatFirst, flatSecond, sum);
+    }
+    delete[] order;
+    return 0;
+}
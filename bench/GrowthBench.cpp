@@ -0,0 +1,113 @@
+// worst single append and peak memory of a growing node array. peak RSS
+// counts for the whole process, so each mode is its own run:
+//   chunked   n pushes into DynamicArray
+//   doubling  n pushes into a copy-on-grow array, as DynamicArray was
+//   huntech   10000 squads then n add_hunter calls
+// the nodes pushed are 136 bytes, the size of a hunter node before the
+// union fields were split
+//   GrowthBench chunked|doubling|huntech [n]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "DynamicArray.h"
+#include "Huntech26a2.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+struct Node {
+    int fields[34];
+};
+
+// doubles and copies every node across, the old and new arrays live at once
+class DoublingArray {
+    Node* nodes;
+    int size;
+    int capacity;
+
+public:
+    DoublingArray() : nodes(nullptr), size(0), capacity(0) {}
+
+    ~DoublingArray() {
+        delete[] nodes;
+    }
+
+    void push_back(const Node& node) {
+        if (size == capacity) {
+            int newCapacity = capacity == 0 ? 16 : capacity * 2;
+            Node* temp = new Node[newCapacity];
+            for (int i = 0; i < size; i++) temp[i] = nodes[i];
+            delete[] nodes;
+            nodes = temp;
+            capacity = newCapacity;
+        }
+        nodes[size++] = node;
+    }
+
+    Node& operator[](int i) {
+        return nodes[i];
+    }
+};
+
+// in MB, 0 where getrusage is missing
+static double peakResident() {
+#if defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1e6;
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1e3;
+#else
+    return 0;
+#endif
+}
+
+// times every call of append(i) for i < n, prints the total and the worst
+template <class F>
+static void measure(const char* name, int n, F append) {
+    double worst = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        auto start = std::chrono::steady_clock::now();
+        append(i);
+        double took = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (took > worst) worst = took;
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("%s, %d appends: total %.2fs, worst %.2f ms, peak RSS %.0f MB\n",
+           name, n, total, worst * 1e3, peakResident());
+}
+
+int main(int argc, char** argv) {
+    const char* mode = argc > 1 ? argv[1] : "huntech";
+    int n = argc > 2 ? atoi(argv[2]) : 10000000;
+    if (strcmp(mode, "chunked") == 0) {
+        DynamicArray<Node> nodes;
+        Node node;
+        memset(&node, 0, sizeof(node));
+        measure("chunked", n, [&](int i) { node.fields[0] = i; nodes.push_back(node); });
+        printf("(last %d)\n", nodes[n - 1].fields[0]);
+    }
+    else if (strcmp(mode, "doubling") == 0) {
+        DoublingArray nodes;
+        Node node;
+        memset(&node, 0, sizeof(node));
+        measure("doubling", n, [&](int i) { node.fields[0] = i; nodes.push_back(node); });
+        printf("(last %d)\n", nodes[n - 1].fields[0]);
+    }
+    else if (strcmp(mode, "huntech") == 0) {
+        Huntech system;
+        NenAbility nen("Enhancer");
+        const int squads = 10000;
+        for (int s = 1; s <= squads; s++) system.add_squad(s);
+        measure("add_hunter", n, [&](int i) { system.add_hunter(i + 1, 1 + i % squads, nen, 1, 0); });
+    }
+    else {
+        printf("usage: GrowthBench chunked|doubling|huntech [n]\n");
+        return 1;
+    }
+    return 0;
+}
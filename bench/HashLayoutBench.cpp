@@ -0,0 +1,153 @@
+// DoubleHashTable's split slot arrays against the interleaved layout it had
+// before: one Entry {key, value, status} per slot. the reference table below
+// probes and grows exactly like DoubleHashTable, so both end with the same
+// capacity and the same probe sequences, only the layout differs. inserts n
+// random keys, then does 5n random finds of which half miss
+//   HashLayoutBench [n] [runs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "DoubleHashTable.h"
+
+static unsigned int state = 1;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the slots as they were: a probe pulls the value and the 4-byte status
+// enum into cache along with the key
+class InterleavedTable {
+    struct Entry {
+        int key;
+        int value;
+        SlotStatus status;
+    };
+    Entry* entries;
+    int capacity;
+    int size;
+
+    static bool isPrime(int n) {
+        if (n <= 1 || n % 2 == 0) return false;
+        for (int i = 3; i * i <= n; i += 2) {
+            if (n % i == 0) return false;
+        }
+        return true;
+    }
+
+    void rehash() {
+        Entry* old = entries;
+        int oldCapacity = capacity;
+        capacity = capacity * 2 + 1;
+        while (!isPrime(capacity)) capacity++;
+        entries = new Entry[capacity];
+        for (int i = 0; i < capacity; i++) entries[i].status = EMPTY;
+        size = 0;
+        for (int i = 0; i < oldCapacity; i++) {
+            if (old[i].status == OCCUPIED) insert(old[i].key, old[i].value);
+        }
+        delete[] old;
+    }
+
+public:
+    InterleavedTable() : entries(new Entry[11]), capacity(11), size(0) {
+        for (int i = 0; i < capacity; i++) entries[i].status = EMPTY;
+    }
+
+    ~InterleavedTable() {
+        delete[] entries;
+    }
+
+    void insert(int key, int value) {
+        if ((double)size / capacity >= LOAD_FACTOR) rehash();
+        int current = (int)((unsigned int)key % capacity);
+        int step = (int)(1 + (unsigned int)key % (capacity - 1));
+        while (entries[current].status == OCCUPIED) {
+            if (entries[current].key == key) {
+                entries[current].value = value;
+                return;
+            }
+            current += step;
+            if (current >= capacity) current -= capacity;
+        }
+        entries[current].key = key;
+        entries[current].value = value;
+        entries[current].status = OCCUPIED;
+        size++;
+    }
+
+    int find(int key) const {
+        int current = (int)((unsigned int)key % capacity);
+        int step = (int)(1 + (unsigned int)key % (capacity - 1));
+        for (int i = 0; i < capacity; i++) {
+            if (entries[current].status == EMPTY) return -1;
+            if (entries[current].status == OCCUPIED && entries[current].key == key) return entries[current].value;
+            current += step;
+            if (current >= capacity) current -= capacity;
+        }
+        return -1;
+    }
+
+    int slots() const {
+        return capacity;
+    }
+};
+
+template <class Table>
+static void run(const char* name, const int* keys, int n, double& insertTime, double& findTime, long long& sum) {
+    auto start = std::chrono::steady_clock::now();
+    Table table;
+    for (int i = 0; i < n; i++) table.insert(keys[i], i);
+    insertTime = since(start);
+    state = 7;
+    sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (long long q = 0; q < 5LL * n; q++) {
+        unsigned int r = nextRandom();
+        // odd keys were never inserted
+        int key = keys[r % (unsigned int)n] + (int)(r >> 31);
+        sum += table.find(key);
+    }
+    findTime = since(start);
+    printf("  %-12s insert %.3fs, find %.3fs (checksum %lld)\n", name, insertTime, findTime, sum);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 4000000;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+    int* keys = new int[n];
+    state = 1;
+    // even keys, so key + 1 is always a miss
+    for (int i = 0; i < n; i++) keys[i] = (int)(nextRandom() & 0x7ffffffe);
+
+    int capacity;
+    {
+        InterleavedTable probe;
+        for (int i = 0; i < n; i++) probe.insert(keys[i], i);
+        capacity = probe.slots();
+    }
+    printf("%d keys, %d slots\n", n, capacity);
+    printf("memory: interleaved %d bytes per slot (%.1f MB), split %d bytes per slot (%.1f MB)\n",
+           (int)(2 * sizeof(int) + sizeof(SlotStatus)), capacity * (2 * sizeof(int) + sizeof(SlotStatus)) / 1e6,
+           (int)(1 + 2 * sizeof(int)), capacity * (1 + 2 * sizeof(int)) / 1e6);
+    for (int r = 0; r < runs; r++) {
+        double insertTime, findTime;
+        long long interleavedSum, splitSum;
+        printf("run %d\n", r);
+        run<InterleavedTable>("interleaved", keys, n, insertTime, findTime, interleavedSum);
+        run<DoubleHashTable<int, int>>("split", keys, n, insertTime, findTime, splitSum);
+        if (interleavedSum != splitSum) {
+            printf("the tables disagree\n");
+            return 1;
+        }
+    }
+    delete[] keys;
+    return 0;
+}
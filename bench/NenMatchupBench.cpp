@@ -0,0 +1,71 @@
+// the Nen kernels against the scalar NenAbility code they replace: the duel
+// tie-break comparison and the += of add_hunter and force_join, over random
+// pairs from a pool of abilities with up to 7 hunters of each type
+//   NenMatchupBench [pairs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "NenVector.h"
+
+#define POOL 4096
+
+static const char* TYPES[NEN_TYPES] = {
+    "Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"
+};
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    long long pairs = argc > 1 ? atoll(argv[1]) : 13000000;
+    srand(5);
+    static NenAbility abilities[POOL];
+    static NenVector vectors[POOL];
+    for (int p = 0; p < POOL; p++) {
+        for (int t = 0; t < NEN_TYPES; t++) {
+            for (int count = rand() % 8; count > 0; count--) abilities[p] += NenAbility(TYPES[t]);
+        }
+        vectors[p] = NenVector::fromAbility(abilities[p]);
+    }
+    int* first = new int[pairs];
+    int* second = new int[pairs];
+    for (long long i = 0; i < pairs; i++) {
+        first[i] = rand() % POOL;
+        second[i] = rand() % POOL;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long long scalarWins = 0;
+    for (long long i = 0; i < pairs; i++) scalarWins += abilities[first[i]] > abilities[second[i]];
+    double scalarTime = since(start);
+
+    start = std::chrono::steady_clock::now();
+    long long kernelWins = 0;
+    for (long long i = 0; i < pairs; i++) kernelWins += vectors[first[i]].matchup(vectors[second[i]]) > 0;
+    double kernelTime = since(start);
+
+    printf("comparison: NenAbility operator> %.1f ns, NenVector::matchup %.1f ns\n",
+           scalarTime * 1e9 / pairs, kernelTime * 1e9 / pairs);
+
+    start = std::chrono::steady_clock::now();
+    NenAbility abilitySum;
+    for (long long i = 0; i < pairs; i++) abilitySum += abilities[first[i]];
+    double scalarAdd = since(start);
+
+    start = std::chrono::steady_clock::now();
+    NenVector vectorSum;
+    for (long long i = 0; i < pairs; i++) vectorSum += vectors[first[i]];
+    double kernelAdd = since(start);
+
+    printf("+=: NenAbility %.1f ns, NenVector %.1f ns\n", scalarAdd * 1e9 / pairs, kernelAdd * 1e9 / pairs);
+
+    delete[] first;
+    delete[] second;
+    if (scalarWins != kernelWins || vectorSum.toAbility().getEffectiveNenAbility() !=
+                                    abilitySum.getEffectiveNenAbility()) {
+        printf("the kernels disagree with NenAbility\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+// mixed insert/find/remove traffic on the hunter index, RobinHoodTable
+// against DoubleHashTable. a long run of removals and reinsertions is where
+// the tombstones of double hashing pile up
+//   RobinHoodBench [operations] [key range]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "DoubleHashTable.h"
+#include "RobinHoodTable.h"
+
+static unsigned int state = 12345;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// 40% finds, 30% inserts, 30% removes over ids 1..range, returns the seconds
+template <class Table>
+static double run(Table& table, long long operations, int range, long long& hits) {
+    state = 12345;
+    hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < operations; i++) {
+        unsigned int r = nextRandom();
+        int key = 1 + (int)((r >> 4) % (unsigned int)range);
+        int op = (int)(r & 15) % 10;
+        if (op < 4) {
+            if (table.find(key) != -1) hits++;
+        }
+        else if (op < 7) table.insert(key, key);
+        else table.remove(key);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    long long operations = argc > 1 ? atoll(argv[1]) : 20000000;
+    int range = argc > 2 ? atoi(argv[2]) : 200000;
+
+    long long robinHits;
+    RobinHoodTable<int, int> robin;
+    double robinTime = run(robin, operations, range, robinHits);
+    printf("robin hood:     %.2fs, %lld hits, %d keys, probes avg %.2f max %d\n",
+           robinTime, robinHits, robin.count(), robin.averageProbeLength(), robin.maxProbeLength());
+
+    long long doubleHits;
+    DoubleHashTable<int, int> hashed;
+    double doubleTime = run(hashed, operations, range, doubleHits);
+    printf("double hashing: %.2fs, %lld hits\n", doubleTime, doubleHits);
+
+    if (robinHits != doubleHits) {
+        printf("the tables disagree\n");
+        return 1;
+    }
+    return 0;
+}
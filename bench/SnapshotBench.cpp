@@ -0,0 +1,122 @@
+// restart time of one state three ways: load_snapshot of a saved file,
+// bulk_load of the roster it came from, and recover from the log of the
+// same adds. the hunters go to random squads with random types, auras and
+// fights. the files are written in the working directory and removed after
+//   SnapshotBench [squads] [hunters] [runs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Huntech26a2.h"
+
+#define BENCH_SNAPSHOT "SnapshotBench.snapshot"
+#define BENCH_ROSTER "SnapshotBench.roster"
+#define BENCH_LOG "SnapshotBench.log"
+
+static const char* const TYPES[] = {"Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"};
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void fail(const char* what) {
+    printf("%s failed\n", what);
+    exit(1);
+}
+
+// a few answers that must agree between the restarted systems
+static long long probe(Huntech& system, int squads, int hunters) {
+    long long sum = 0;
+    for (int h = 1; h <= hunters; h += hunters / 64 + 1) sum += system.get_hunter_fights_number(h).ans();
+    for (int s = 1; s <= squads; s += squads / 64 + 1) sum += system.get_squad_experience(s).ans();
+    return sum + system.get_ith_collective_aura_squad(squads / 2 + 1).ans();
+}
+
+int main(int argc, char** argv) {
+    int squads = argc > 1 ? atoi(argv[1]) : 100000;
+    int hunters = argc > 2 ? atoi(argv[2]) : 1000000;
+    int runs = argc > 3 ? atoi(argv[3]) : 3;
+    int* squadOf = new int[hunters + 1];
+    int* typeOf = new int[hunters + 1];
+    int* auraOf = new int[hunters + 1];
+    int* fightsOf = new int[hunters + 1];
+    srand(3);
+    for (int h = 1; h <= hunters; h++) {
+        squadOf[h] = 1 + rand() % squads;
+        typeOf[h] = rand() % 6;
+        auraOf[h] = rand() % 1000;
+        fightsOf[h] = rand() % 50;
+    }
+
+    FILE* roster = fopen(BENCH_ROSTER, "w");
+    if (!roster) fail("writing the roster");
+    fprintf(roster, "%d\n", squads);
+    for (int s = 1; s <= squads; s++) fprintf(roster, "%d\n", s);
+    fprintf(roster, "%d\n", hunters);
+    for (int h = 1; h <= hunters; h++) {
+        fprintf(roster, "%d %d %s %d %d\n", h, squadOf[h], TYPES[typeOf[h]], auraOf[h], fightsOf[h]);
+    }
+    fclose(roster);
+
+    // the same adds through a log, a group of 4096 per fsync
+    remove(BENCH_LOG);
+    {
+        Huntech logged;
+        if (logged.open_log(BENCH_LOG, 4096, 0) != StatusType::SUCCESS) fail("open_log");
+        for (int s = 1; s <= squads; s++) logged.add_squad(s);
+        for (int h = 1; h <= hunters; h++) {
+            logged.add_hunter(h, squadOf[h], NenAbility(TYPES[typeOf[h]]), auraOf[h], fightsOf[h]);
+        }
+        if (logged.close_log() != StatusType::SUCCESS) fail("close_log");
+    }
+
+    printf("%d squads, %d hunters, ms per restart\n", squads, hunters);
+    for (int run = 0; run < runs; run++) {
+        long long answers[3];
+
+        auto start = std::chrono::steady_clock::now();
+        Huntech* fromRoster = new Huntech();
+        if (fromRoster->bulk_load(BENCH_ROSTER) != StatusType::SUCCESS) fail("bulk_load");
+        double bulkTime = since(start);
+        answers[0] = probe(*fromRoster, squads, hunters);
+
+        start = std::chrono::steady_clock::now();
+        if (fromRoster->save_snapshot(BENCH_SNAPSHOT) != StatusType::SUCCESS) fail("save_snapshot");
+        double saveTime = since(start);
+        delete fromRoster;
+
+        start = std::chrono::steady_clock::now();
+        Huntech* fromSnapshot = new Huntech();
+        if (fromSnapshot->load_snapshot(BENCH_SNAPSHOT) != StatusType::SUCCESS) fail("load_snapshot");
+        double loadTime = since(start);
+        answers[1] = probe(*fromSnapshot, squads, hunters);
+        delete fromSnapshot;
+
+        // the part of the load spent on the checksum
+        start = std::chrono::steady_clock::now();
+        {
+            SnapshotReader in(BENCH_SNAPSHOT);
+            if (!in.verifyChecksum()) fail("verifyChecksum");
+        }
+        double checksumTime = since(start);
+
+        start = std::chrono::steady_clock::now();
+        Huntech* fromLog = new Huntech();
+        if (fromLog->recover(nullptr, BENCH_LOG) != StatusType::SUCCESS) fail("recover");
+        double replayTime = since(start);
+        answers[2] = probe(*fromLog, squads, hunters);
+        delete fromLog;
+
+        if (answers[0] != answers[1] || answers[0] != answers[2]) fail("comparing the answers");
+        printf("load_snapshot %7.1f (checksum %5.1f)   bulk_load %7.1f   replay %7.1f   save %7.1f\n",
+               loadTime * 1e3, checksumTime * 1e3, bulkTime * 1e3, replayTime * 1e3, saveTime * 1e3);
+    }
+
+    remove(BENCH_SNAPSHOT);
+    remove(BENCH_ROSTER);
+    remove(BENCH_LOG);
+    delete[] squadOf;
+    delete[] typeOf;
+    delete[] auraOf;
+    delete[] fightsOf;
+    return 0;
+}
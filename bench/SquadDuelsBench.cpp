@@ -0,0 +1,80 @@
+// squad_duels against the same pairs through squad_duel one at a time, on
+// two systems built alike: squads of a few hunters and random pairs over
+// them, a pair in a hundred naming a squad that does not exist. the two
+// must give the same outcomes
+//   SquadDuelsBench [squads] [hunters per squad] [pairs] [runs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Huntech26a2.h"
+
+static const char* const TYPES[] = {"Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"};
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void build(Huntech& system, int squads, int size) {
+    srand(5);
+    int hunterId = 1;
+    for (int s = 1; s <= squads; s++) {
+        system.add_squad(s);
+        for (int k = 0; k < size; k++) system.add_hunter(hunterId++, s, NenAbility(TYPES[rand() % 6]), rand() % 100, 0);
+    }
+}
+
+int main(int argc, char** argv) {
+    int squads = argc > 1 ? atoi(argv[1]) : 200000;
+    int size = argc > 2 ? atoi(argv[2]) : 10;
+    int pairs = argc > 3 ? atoi(argv[3]) : 2000000;
+    int runs = argc > 4 ? atoi(argv[4]) : 3;
+    int* first = new int[pairs];
+    int* second = new int[pairs];
+    int* outcomes = new int[pairs];
+    StatusType* results = new StatusType[pairs];
+    srand(8);
+    for (int i = 0; i < pairs; i++) {
+        first[i] = 1 + rand() % squads;
+        second[i] = 1 + rand() % squads;
+        if (rand() % 100 == 0) second[i] = squads + 1;
+    }
+
+    printf("%d squads of %d hunters, %d pairs, ns per duel\n", squads, size, pairs);
+    for (int run = 0; run < runs; run++) {
+        unsigned long long singleSum = 0;
+        double singleTime;
+        {
+            Huntech system;
+            build(system, squads, size);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < pairs; i++) {
+                output_t<int> result = system.squad_duel(first[i], second[i]);
+                singleSum = singleSum * 31 + (result.status() == StatusType::SUCCESS ? result.ans() : 10 + (int)result.status());
+            }
+            singleTime = since(start);
+        }
+
+        unsigned long long batchSum = 0;
+        double batchTime;
+        {
+            Huntech system;
+            build(system, squads, size);
+            auto start = std::chrono::steady_clock::now();
+            system.squad_duels(first, second, pairs, outcomes, results);
+            batchTime = since(start);
+            for (int i = 0; i < pairs; i++) {
+                batchSum = batchSum * 31 + (results[i] == StatusType::SUCCESS ? outcomes[i] : 10 + (int)results[i]);
+            }
+        }
+        printf("run %d: squad_duel %.0f, squad_duels %.0f\n", run, singleTime * 1e9 / pairs, batchTime * 1e9 / pairs);
+        if (singleSum != batchSum) {
+            printf("the outcomes disagree\n");
+            return 1;
+        }
+    }
+    delete[] first;
+    delete[] second;
+    delete[] outcomes;
+    delete[] results;
+    return 0;
+}
@@ -0,0 +1,91 @@
+// memory per squad and the squad calls of Huntech on a large pool: n squads
+// added, a hunter added to each, random duels between them, then every
+// squad removed in a random order. the memory is the growth of peak RSS
+// over the adds, so it counts the pool's records and buckets as allocated
+//   SquadPoolBench [squads] [duels]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Huntech26a2.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+static unsigned int state = 1;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// in bytes, 0 where getrusage is missing
+static double peakResident() {
+#if defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (double)usage.ru_maxrss;
+#elif defined(__unix__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024.0;
+#else
+    return 0;
+#endif
+}
+
+static void shuffle(int* ids, int n) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(nextRandom() % (unsigned int)(i + 1));
+        int temp = ids[i];
+        ids[i] = ids[j];
+        ids[j] = temp;
+    }
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int duels = argc > 2 ? atoi(argv[2]) : 4000000;
+    int* order = new int[n];
+    for (int i = 0; i < n; i++) order[i] = i + 1;
+    shuffle(order, n);
+    printf("%d squads (Squad is %d bytes), %d duels, ns per call\n", n, (int)sizeof(Squad), duels);
+
+    Huntech system;
+    double before = peakResident();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) system.add_squad(order[i]);
+    double addSquad = since(start);
+    double perSquad = (peakResident() - before) / n;
+
+    NenAbility nen("Enhancer");
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) system.add_hunter(i + 1, order[i], nen, i % 100, 0);
+    double addHunter = since(start);
+
+    long long sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < duels; i++) {
+        int a = 1 + (int)(nextRandom() % (unsigned int)n);
+        int b = 1 + (int)(nextRandom() % (unsigned int)n);
+        output_t<int> result = system.squad_duel(a, b);
+        if (result.status() == StatusType::SUCCESS) sum += result.ans();
+    }
+    double duel = since(start);
+
+    shuffle(order, n);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) system.remove_squad(order[i]);
+    double removeSquad = since(start);
+
+    printf("  add_squad %.0f, add_hunter %.0f, squad_duel %.0f, remove_squad %.0f\n",
+           addSquad * 1e9 / n, addHunter * 1e9 / n, duel * 1e9 / duels, removeSquad * 1e9 / n);
+    printf("  %.0f bytes per squad (checksum %lld)\n", perSquad, sum);
+    delete[] order;
+    return 0;
+}
@@ -0,0 +1,98 @@
+// the three find policies of Union over adversarial union orders. each
+// scenario builds n nodes, then runs fightsHad and partialAbility on every
+// node in a random order; prints build time and the two query passes
+//   UnionCompressionBench [n]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Hunter.h"
+#include "Union.h"
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static NenVector typeVector(int i) {
+    NenVector nen;
+    nen.lanes[i % NEN_TYPES] = 1;
+    return nen;
+}
+
+// rounds of pairwise merges of equal sets, binomial trees of depth log n.
+// forcingLarger keeps the forcing side the root, otherwise force_join order
+// hangs the forcing side under the forced one
+template <class Policy>
+static void pairwise(Union<Hunter, Policy>& u, int n, bool forcingLarger) {
+    for (int i = 0; i < n; i++) u.makeSet(Hunter(i + 1, typeVector(i), 0, i % 3));
+    for (int step = 1; step < n; step *= 2) {
+        for (int i = 0; i + step < n; i += 2 * step) {
+            if (forcingLarger) u.combine(i, i + step, 1);
+            else {
+                // a forced set one node larger wins the root under order 1
+                u.makeSet(Hunter(n + i + 1, typeVector(i), 0, 0));
+                u.combine(i + step, u.count() - 1, 0);
+                u.combine(i, i + step, 1);
+            }
+            u.addFight(u.find(i), u.find(i));
+        }
+    }
+}
+
+// one squad grown by one hunter at a time, each add followed by a duel
+template <class Policy>
+static void grown(Union<Hunter, Policy>& u, int n) {
+    u.makeSet(Hunter(1, typeVector(0), 0, 0));
+    for (int i = 1; i < n; i++) {
+        int idx = u.makeSet(Hunter(i + 1, typeVector(i), 0, i % 3));
+        u.combine(0, idx, 0);
+        int root = u.find(0);
+        u.addFight(root, root);
+    }
+}
+
+template <class Policy>
+static void run(const char* name, int scenario, int n, const int* order) {
+    auto start = std::chrono::steady_clock::now();
+    Union<Hunter, Policy> u;
+    if (scenario == 2) grown(u, n);
+    else pairwise(u, n, scenario == 0);
+    double build = since(start);
+
+    int count = u.count();
+    start = std::chrono::steady_clock::now();
+    long long fights = 0;
+    for (int i = 0; i < count; i++) fights += u.fightsHad(order[i] % count);
+    double fightsTime = since(start);
+    start = std::chrono::steady_clock::now();
+    long long effective = 0;
+    for (int i = 0; i < count; i++) effective += u.partialAbility(order[i] % count).effective();
+    double nenTime = since(start);
+    printf("  %-10s build %.2fs, fightsHad %.2fs, partialAbility %.2fs (checksum %lld %lld)\n",
+           name, build, fightsTime, nenTime, fights, effective);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 4000000;
+    int* order = new int[2 * n];
+    for (int i = 0; i < 2 * n; i++) order[i] = i;
+    srand(3);
+    for (int i = 2 * n - 1; i > 0; i--) {
+        int j = (int)(((long long)rand() * RAND_MAX + rand()) % (i + 1));
+        int temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
+    const char* titles[] = {
+        "pairwise merges, forcing side larger",
+        "pairwise merges, forced side larger",
+        "one squad grown one hunter at a time"
+    };
+    for (int scenario = 0; scenario < 3; scenario++) {
+        printf("%s\n", titles[scenario]);
+        run<FullCompression>("full", scenario, n, order);
+        run<PathHalving>("halving", scenario, n, order);
+        run<PathSplitting>("splitting", scenario, n, order);
+    }
+    delete[] order;
+    return 0;
+}
@@ -0,0 +1,66 @@
+// find chains and combine throughput of Union<Hunter>: n hunters in squads
+// of 1000, squads merged pairwise in force_join order until one set is left,
+// then n fightsHad queries on random hunters. the hunters are built with the
+// Union and Hunter calls that predate the hot/cold split, so the bench also
+// builds against the layout before it
+//   UnionLayoutBench [n] [runs]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Hunter.h"
+#include "Union.h"
+
+#define SQUAD_SIZE 1000
+
+static unsigned int state = 1;
+
+static unsigned int nextRandom() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 10000000;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+    int squads = (n + SQUAD_SIZE - 1) / SQUAD_SIZE;
+    printf("%d hunters, squads of %d\n", n, SQUAD_SIZE);
+    for (int run = 0; run < runs; run++) {
+        Union<Hunter> sets;
+        for (int i = 0; i < n; i++) sets.makeSet(Hunter(i + 1, {}, 0, i % 7));
+
+        // every hunter joins the head of its squad as add_hunter does, then
+        // the squads merge pairwise with the forcing side first
+        long long combines = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            if (i % SQUAD_SIZE == 0) continue;
+            sets.combine(i - i % SQUAD_SIZE, i, 0);
+            combines++;
+        }
+        for (int step = 1; step < squads; step *= 2) {
+            for (int s = 0; s + step < squads; s += 2 * step) {
+                int forcing = sets.find((s + step) * SQUAD_SIZE);
+                int forced = sets.find(s * SQUAD_SIZE);
+                sets.combine(forcing, forced, 1);
+                sets.addFight(sets.find(forcing), sets.find(forcing));
+                combines++;
+            }
+        }
+        double combineTime = since(start);
+
+        state = 1;
+        long long sum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < n; q++) sum += sets.fightsHad((int)(nextRandom() % (unsigned int)n));
+        double queryTime = since(start);
+        printf("run %d: %lld combines %.2fs, %d fightsHad %.2fs (checksum %lld)\n",
+               run, combines, combineTime, n, queryTime, sum);
+    }
+    return 0;
+}
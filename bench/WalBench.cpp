@@ -0,0 +1,58 @@
+// throughput of logged changes under different commit policies: no log,
+// group commit by size alone, and by a time window alone. the changes are
+// add_hunter and squad_duel in turns over 1000 squads, the last group is
+// synced inside the timing. the log is written in the working directory
+// and removed after
+//   WalBench [changes] [changes with a group of 1]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "Huntech26a2.h"
+
+#define BENCH_LOG "WalBench.log"
+#define BENCH_SQUADS 1000
+
+static const char* const TYPES[] = {"Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"};
+
+// changes per second, with no log when groupSize is 0
+static double run(int groupSize, int windowMicros, int changes) {
+    remove(BENCH_LOG);
+    Huntech system;
+    srand(7);
+    for (int s = 1; s <= BENCH_SQUADS; s++) system.add_squad(s);
+    NenAbility types[6];
+    for (int i = 0; i < 6; i++) types[i] = NenAbility(TYPES[i]);
+    if (groupSize > 0 && system.open_log(BENCH_LOG, groupSize, windowMicros) != StatusType::SUCCESS) {
+        printf("open_log failed\n");
+        exit(1);
+    }
+    auto start = std::chrono::steady_clock::now();
+    int hunterId = 1;
+    for (int i = 0; i < changes; i++) {
+        if (i % 2 == 0) system.add_hunter(hunterId++, 1 + rand() % BENCH_SQUADS, types[rand() % 6], rand() % 50, 0);
+        else system.squad_duel(1 + rand() % BENCH_SQUADS, 1 + rand() % BENCH_SQUADS);
+    }
+    if (groupSize > 0 && system.close_log() != StatusType::SUCCESS) {
+        printf("close_log failed\n");
+        exit(1);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    remove(BENCH_LOG);
+    return changes / seconds;
+}
+
+int main(int argc, char** argv) {
+    int changes = argc > 1 ? atoi(argv[1]) : 200000;
+    int single = argc > 2 ? atoi(argv[2]) : 20000;
+    printf("changes per second\n");
+    printf("no log:               %10.0f\n", run(0, 0, changes));
+    const int groups[] = {1, 16, 256, 4096};
+    for (int group : groups) {
+        printf("group %4d:           %10.0f\n", group, run(group, 0, group == 1 ? single : changes));
+    }
+    const int windows[] = {100, 1000, 10000};
+    for (int window : windows) {
+        printf("window %5d us:      %10.0f\n", window, run(1 << 30, window, changes));
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// AdaptiveIdIndex: dense ids in any order end in the flat array, scattered
+// ids stay hashed, and random traffic across both forms matches a flat oracle
+#include <cstdio>
+#include <cstdlib>
+#include "AdaptiveIdIndex.h"
+#include "Check.h"
+
+// the id range of the random traffic
+#define RANGE 200000
+
+static void shuffle(int* ids, int n) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int temp = ids[i];
+        ids[i] = ids[j];
+        ids[j] = temp;
+    }
+}
+
+// ids 1..n in a random order
+static void shuffledDense(int n) {
+    int* ids = new int[n];
+    for (int i = 0; i < n; i++) ids[i] = i + 1;
+    shuffle(ids, n);
+    AdaptiveIdIndex<int, int> index;
+    for (int i = 0; i < n; i++) {
+        bool inserted = false;
+        index.try_emplace(ids[i], inserted) = ids[i] * 2;
+        CHECK(inserted);
+    }
+    CHECK(index.isDense());
+    CHECK(index.count() == n);
+    for (int id = 1; id <= n; id++) CHECK(index.find(id) == id * 2);
+    CHECK(index.find(0) == -1 && index.find(n + 1) == -1);
+    delete[] ids;
+}
+
+// ids spread over the whole positive range never fit the flat array
+static void scattered(int n) {
+    AdaptiveIdIndex<int, int> index;
+    for (int i = 0; i < n; i++) index.insert(1 + (int)((unsigned int)i * 2654435761u % 2000000000u), i);
+    CHECK(!index.isDense());
+    for (int i = 0; i < n; i++) CHECK(index.find(1 + (int)((unsigned int)i * 2654435761u % 2000000000u)) == i);
+}
+
+// one far id sends the index to the hash form; once it is removed and the
+// count doubles the index is flat again
+static void backToDense() {
+    AdaptiveIdIndex<int, int> index;
+    for (int id = 1; id <= 5000; id++) index.insert(id, id);
+    CHECK(index.isDense());
+    index.insert(1000000000, 7);
+    CHECK(!index.isDense());
+    index.remove(1000000000);
+    for (int id = 5001; id <= 20000; id++) index.insert(id, id);
+    CHECK(index.isDense());
+    for (int id = 1; id <= 20000; id++) CHECK(index.find(id) == id);
+    CHECK(index.find(1000000000) == -1);
+}
+
+// random inserts, removes and finds, with rare far ids moving it between forms
+static void randomTraffic() {
+    static int expected[RANGE + 1];
+    for (int i = 0; i <= RANGE; i++) expected[i] = -1;
+    int farKey = 0;
+    int farValue = -1;
+    int present = 0;
+    AdaptiveIdIndex<int, int> index;
+    bool sawDense = false;
+    bool sawSparse = false;
+    for (int step = 0; step < 600000; step++) {
+        int op = rand() % 100;
+        int key = 1 + rand() % RANGE;
+        if (op == 0 && farValue == -1) {
+            farKey = 1500000000 + rand() % 1000;
+            farValue = step;
+            index.insert(farKey, farValue);
+            present++;
+        }
+        else if (op == 1 && farValue != -1) {
+            index.remove(farKey);
+            farValue = -1;
+            present--;
+        }
+        else if (op < 60) {
+            bool inserted = false;
+            int& value = index.try_emplace(key, inserted);
+            CHECK(inserted == (expected[key] == -1));
+            if (inserted) present++;
+            else CHECK(value == expected[key]);
+            value = step;
+            expected[key] = step;
+        }
+        else if (op < 80) {
+            if (expected[key] != -1) present--;
+            index.remove(key);
+            expected[key] = -1;
+        }
+        else {
+            CHECK(index.find(key) == expected[key]);
+            int* slot = index.lookup(key);
+            CHECK(slot ? *slot == expected[key] : expected[key] == -1);
+        }
+        CHECK(index.count() == present);
+        if (index.isDense()) sawDense = true;
+        else sawSparse = true;
+    }
+    for (int k = 1; k <= RANGE; k++) CHECK(index.find(k) == expected[k]);
+    if (farValue != -1) CHECK(index.find(farKey) == farValue);
+    CHECK(sawDense && sawSparse);
+}
+
+int main() {
+    srand(11);
+    shuffledDense(1000);
+    shuffledDense(1000000);
+    scattered(100000);
+    backToDense();
+    randomTraffic();
+    return checkResult();
+}
@@ -0,0 +1,20 @@
+// the check of every unit test: a condition that does not hold is printed
+// with its place and counted, main returns checkResult(). the count is
+// atomic so that threads can check too
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <atomic>
+#include <cstdio>
+
+static std::atomic<int> failures(0);
+
+#define CHECK(cond) do { if (!(cond)) { failures++; printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); } } while (0)
+
+// prints the verdict, the exit code of the test
+static int checkResult() {
+    printf("%s\n", failures.load() ? "FAILED" : "ok");
+    return failures.load() != 0;
+}
+
+#endif //CHECK_H
@@ -0,0 +1,96 @@
+// ConcurrentHashTable under threads: writers insert, remove and reinsert
+// their own key ranges (growing the table through many resizes) while
+// readers check every answer they get is a whole entry. the final contents
+// are then compared with what the writers left
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "ConcurrentHashTable.h"
+#include "Check.h"
+
+#define WRITERS 4
+#define READERS 4
+#define KEYS_PER_WRITER 100000
+#define ROUNDS 3
+
+// the value a key carries in a round, readers recognise any of them
+static int valueFor(int key, int round) {
+    return key * 4 + round;
+}
+
+static void writer(ConcurrentHashTable<int, int>& table, int w) {
+    int first = 1 + w * KEYS_PER_WRITER;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int k = first; k < first + KEYS_PER_WRITER; k++) {
+            if (round == 0) CHECK(table.try_insert(k, valueFor(k, round)));
+            else table.insert(k, valueFor(k, round));
+        }
+        // drop the odd keys, the next round puts them back
+        for (int k = first + 1; k < first + KEYS_PER_WRITER; k += 2) table.remove(k);
+    }
+    CHECK(!table.try_insert(first, 0));
+}
+
+static void reader(const ConcurrentHashTable<int, int>& table, const std::atomic<bool>& done, int r) {
+    unsigned int state = 17 + r;
+    long long found = 0;
+    while (!done.load()) {
+        state = state * 1103515245u + 12345u;
+        int key = 1 + (int)((state >> 8) % (WRITERS * KEYS_PER_WRITER));
+        int value = table.find(key);
+        if (value == -1) continue;
+        found++;
+        CHECK(value / 4 == key && value % 4 < ROUNDS);
+    }
+    CHECK(found >= 0);
+}
+
+int main() {
+    ConcurrentHashTable<int, int> table;
+
+    // the reserved keys are refused and never found
+    bool refused = false;
+    try {
+        table.insert(0, 1);
+    }
+    catch (StatusType e) {
+        refused = e == StatusType::INVALID_INPUT;
+    }
+    CHECK(refused);
+    refused = false;
+    try {
+        table.try_insert((int)0x80000000u, 1);
+    }
+    catch (StatusType e) {
+        refused = e == StatusType::INVALID_INPUT;
+    }
+    CHECK(refused);
+    CHECK(table.find(0) == -1 && table.find((int)0x80000000u) == -1);
+    table.remove(0);
+    CHECK(table.count() == 0);
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < READERS; r++) threads.emplace_back(reader, std::cref(table), std::cref(done), r);
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITERS; w++) writers.emplace_back(writer, std::ref(table), w);
+    for (std::thread& t : writers) t.join();
+    done.store(true);
+    for (std::thread& t : threads) t.join();
+
+    // every reader is joined, the replaced arrays can go
+    table.reclaim();
+    int expected = 0;
+    for (int k = 1; k <= WRITERS * KEYS_PER_WRITER; k++) {
+        int offset = (k - 1) % KEYS_PER_WRITER;
+        if (offset % 2 == 1) CHECK(table.find(k) == -1);
+        else {
+            CHECK(table.find(k) == valueFor(k, ROUNDS - 1));
+            expected++;
+        }
+    }
+    CHECK(table.count() == expected);
+
+    return checkResult();
+}
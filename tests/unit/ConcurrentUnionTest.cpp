@@ -0,0 +1,185 @@
+// ConcurrentUnion under threads, checked against Union run on one thread:
+//  - threads make sets at once, every index is handed out once and keeps
+//    the hunter it was made with
+//  - writers combine, fight and gain experience inside their own block of
+//    nodes while readers walk (and split) paths across all of them. blocks
+//    never meet, so replaying each writer's log on a Union in any order
+//    gives the answers the concurrent one must give
+//  - everything is joined into one set and every thread fights on it, so
+//    all writers fight over the same root lock
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "ConcurrentUnion.h"
+#include "Union.h"
+#include "Hunter.h"
+#include "Check.h"
+
+#define THREADS 4
+#define BLOCK 20000
+#define OPS_PER_WRITER 60000
+#define SHARED_FIGHTS 20000
+
+enum { OP_COMBINE, OP_FORCE, OP_FIGHT, OP_EXP };
+
+struct Op {
+    int kind;
+    int a;
+    int b;
+};
+
+static unsigned int nextRandom(unsigned int& state) {
+    state = state * 1103515245u + 12345u;
+    return state >> 8;
+}
+
+static Hunter hunterFor(int idx) {
+    NenVector nen;
+    nen.lanes[idx % NEN_TYPES] = 1 + idx % 7;
+    return Hunter(idx + 1, nen, 1, idx % 5);
+}
+
+static bool sameNen(const NenVector& a, const NenVector& b) {
+    for (int j = 0; j < NEN_LANES; j++) {
+        if (a.lanes[j] != b.lanes[j]) return false;
+    }
+    return true;
+}
+
+static void maker(ConcurrentUnion<Hunter>& sets, std::vector<int>& made, int t) {
+    for (int i = 0; i < BLOCK; i++) {
+        int idx = sets.makeSet(Hunter(t * BLOCK + i + 1, NenVector(), 1, t * BLOCK + i));
+        made.push_back(idx);
+    }
+}
+
+static void writer(ConcurrentUnion<Hunter>& sets, std::vector<Op>& log, int t) {
+    unsigned int state = 91 + t;
+    int first = t * BLOCK;
+    for (int i = 0; i < OPS_PER_WRITER; i++) {
+        int a = first + (int)(nextRandom(state) % BLOCK);
+        int b = first + (int)(nextRandom(state) % BLOCK);
+        int kind = (int)(nextRandom(state) % 4);
+        if (kind == OP_COMBINE || kind == OP_FORCE) {
+            if (sets.find(a) == sets.find(b)) continue;
+            sets.combine(a, b, kind == OP_FORCE ? 1 : 0);
+        }
+        else if (kind == OP_FIGHT) sets.addFight(a, b);
+        else sets.add_exp(a, b - first);
+        Op op = {kind, a, b};
+        log.push_back(op);
+    }
+}
+
+// roots never leave their block and no node ever loses a fight
+static void reader(ConcurrentUnion<Hunter>& sets, const std::atomic<bool>& done, int r) {
+    unsigned int state = 7 + r;
+    std::vector<int> seen(THREADS * BLOCK, 0);
+    while (!done.load()) {
+        int idx = (int)(nextRandom(state) % (THREADS * BLOCK));
+        int root = sets.find(idx);
+        CHECK(root / BLOCK == idx / BLOCK);
+        int fights = sets.fightsHad(idx);
+        CHECK(fights >= seen[idx]);
+        seen[idx] = fights;
+    }
+}
+
+static void replay(Union<Hunter>& sets, const std::vector<Op>& log, int first) {
+    for (const Op& op : log) {
+        int rootA = sets.find(op.a);
+        int rootB = sets.find(op.b);
+        if (op.kind == OP_COMBINE || op.kind == OP_FORCE) sets.combine(rootA, rootB, op.kind == OP_FORCE ? 1 : 0);
+        else if (op.kind == OP_FIGHT) sets.addFight(rootA, rootB);
+        else sets.add_exp(rootA, op.b - first);
+    }
+}
+
+static void sharedFighter(ConcurrentUnion<Hunter>& sets, int t) {
+    unsigned int state = 300 + t;
+    for (int i = 0; i < SHARED_FIGHTS; i++) {
+        sets.addFight((int)(nextRandom(state) % (THREADS * BLOCK)), (int)(nextRandom(state) % (THREADS * BLOCK)));
+    }
+}
+
+static void compare(ConcurrentUnion<Hunter>& sets, Union<Hunter>& expected) {
+    int mismatches = 0;
+    for (int idx = 0; idx < THREADS * BLOCK; idx++) {
+        int root = expected.find(idx);
+        if (sets.find(idx) != root
+            || sets.fightsHad(idx) != expected.fightsHad(idx)
+            || !sameNen(sets.partialAbility(idx), expected.partialAbility(idx))
+            || sets.get_exp(idx) != expected.get_exp(idx)
+            || sets.lastChrono(idx) != expected.lastChrono(root)) {
+            mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+int main() {
+    {
+        ConcurrentUnion<Hunter> sets;
+        std::vector<std::vector<int>> made(THREADS);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) threads.emplace_back(maker, std::ref(sets), std::ref(made[t]), t);
+        for (std::thread& t : threads) t.join();
+        CHECK(sets.count() == THREADS * BLOCK);
+        std::vector<int> owner(THREADS * BLOCK, -1);
+        for (int t = 0; t < THREADS; t++) {
+            for (int i = 0; i < BLOCK; i++) {
+                int idx = made[t][i];
+                CHECK(owner[idx] == -1);
+                owner[idx] = t;
+                CHECK(sets.find(idx) == idx && sets.fightsHad(idx) == t * BLOCK + i);
+            }
+        }
+    }
+
+    ConcurrentUnion<Hunter> sets;
+    Union<Hunter> expected;
+    for (int idx = 0; idx < THREADS * BLOCK; idx++) {
+        CHECK(sets.makeSet(hunterFor(idx)) == idx);
+        expected.makeSet(hunterFor(idx));
+    }
+
+    std::vector<std::vector<Op>> logs(THREADS);
+    std::atomic<bool> done(false);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < THREADS; r++) readers.emplace_back(reader, std::ref(sets), std::cref(done), r);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; t++) writers.emplace_back(writer, std::ref(sets), std::ref(logs[t]), t);
+    for (std::thread& t : writers) t.join();
+    done.store(true);
+    for (std::thread& t : readers) t.join();
+
+    // splits stop once the retired list is as long as the union, the rest
+    // are records the writers replaced
+    long long writes = 0;
+    for (int t = 0; t < THREADS; t++) writes += logs[t].size();
+    CHECK(sets.retiredRecords() <= sets.count() + 3 * writes);
+    sets.reclaim();
+    CHECK(sets.retiredRecords() == 0);
+
+    for (int t = 0; t < THREADS; t++) replay(expected, logs[t], t * BLOCK);
+    compare(sets, expected);
+
+    // one set for everyone, so every fight takes the same root lock
+    for (int idx = 1; idx < THREADS * BLOCK; idx++) {
+        int root = expected.find(0);
+        int other = expected.find(idx);
+        if (root == other) continue;
+        sets.combine(0, idx, 0);
+        expected.combine(root, other, 0);
+    }
+    std::vector<std::thread> fighters;
+    for (int t = 0; t < THREADS; t++) fighters.emplace_back(sharedFighter, std::ref(sets), t);
+    for (std::thread& t : fighters) t.join();
+    int root = expected.find(0);
+    for (int i = 0; i < THREADS * SHARED_FIGHTS; i++) expected.addFight(root, root);
+    sets.reclaim();
+    compare(sets, expected);
+
+    return checkResult();
+}
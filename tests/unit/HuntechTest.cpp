@@ -0,0 +1,725 @@
+// regression tests for Huntech, one function per case
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Huntech26a2.h"
+#include "Check.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+static int fightsOf(Huntech& system, int hunterId) {
+    output_t<int> result = system.get_hunter_fights_number(hunterId);
+    return result.status() == StatusType::SUCCESS ? result.ans() : -1;
+}
+
+// removed squads are compacted out of the union while their hunters still
+// answer with their final fights, up to INT_MAX which the retired encoding
+// cannot hold: that squad keeps its nodes
+static void compactExtremeFights() {
+    Huntech system;
+    const int squadCount = 1500;
+    for (int s = 1; s <= squadCount; s++) CHECK(system.add_squad(s) == StatusType::SUCCESS);
+    NenAbility nen("Enhancer");
+    CHECK(system.add_hunter(1, 1, nen, 1, INT_MAX) == StatusType::SUCCESS);
+    CHECK(system.add_hunter(2, 2, nen, 1, INT_MAX - 1) == StatusType::SUCCESS);
+    CHECK(system.add_hunter(3, 2, nen, 1, 0) == StatusType::SUCCESS);
+    for (int s = 3; s <= squadCount; s++) CHECK(system.add_hunter(s + 1, s, nen, 1, s) == StatusType::SUCCESS);
+    CHECK(system.squad_duel(3, 4).status() == StatusType::SUCCESS);
+
+    for (int s = 1; s <= squadCount - 1; s++) CHECK(system.remove_squad(s) == StatusType::SUCCESS);
+    CHECK(fightsOf(system, 1) == INT_MAX);
+    CHECK(fightsOf(system, 2) == INT_MAX - 1);
+    CHECK(fightsOf(system, 3) == 0);
+    CHECK(fightsOf(system, 4) == 4);
+    CHECK(fightsOf(system, 5) == 5);
+    for (int s = 5; s <= squadCount; s++) CHECK(fightsOf(system, s + 1) == s);
+    CHECK(system.get_partial_nen_ability(1).status() == StatusType::FAILURE);
+
+    // the system goes on after the compaction
+    CHECK(system.add_squad(1) == StatusType::SUCCESS);
+    CHECK(system.add_hunter(100000, 1, nen, 5, 0) == StatusType::SUCCESS);
+    CHECK(system.squad_duel(1, squadCount).status() == StatusType::SUCCESS);
+    CHECK(fightsOf(system, 100000) == 1);
+    CHECK(fightsOf(system, squadCount + 1) == squadCount + 1);
+    CHECK(system.add_hunter(1, 1, nen, 5, 0) == StatusType::FAILURE);
+}
+
+// two systems alike: squads 1..30 with hunters, 31 empty, 32 removed
+static void buildDuelists(Huntech& system) {
+    const char* types[] = {"Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"};
+    for(int s = 1; s <= 32; s++) CHECK(system.add_squad(s) == StatusType::SUCCESS);
+    for(int h = 1; h <= 120; h++) {
+        CHECK(system.add_hunter(h, 1 + h % 30, NenAbility(types[h % 6]), h % 13, h % 4) == StatusType::SUCCESS);
+    }
+    CHECK(system.remove_squad(32) == StatusType::SUCCESS);
+}
+
+// squad_duels answers like squad_duel called pair by pair, with invalid
+// ids, missing and empty squads in the middle of the batch, and leaves the
+// same experience and fights behind
+static void squadDuelsMatchSingle() {
+    Huntech single;
+    Huntech batch;
+    buildDuelists(single);
+    buildDuelists(batch);
+    const int n = 600;
+    int first[n];
+    int second[n];
+    srand(4);
+    for(int i = 0; i < n; i++) {
+        first[i] = 1 + rand() % 30;
+        second[i] = 1 + rand() % 30;
+    }
+    first[37] = 0;
+    second[38] = -5;
+    second[39] = first[39];
+    second[100] = 31;
+    first[101] = 32;
+    second[102] = 77;
+    first[n - 1] = 31;
+
+    int outcomes[n];
+    StatusType results[n];
+    for(int i = 0; i < n; i++) outcomes[i] = -1;
+    CHECK(batch.squad_duels(first, second, n, outcomes, results) == StatusType::SUCCESS);
+    int mismatches = 0;
+    int fought = 0;
+    for(int i = 0; i < n; i++) {
+        output_t<int> expected = single.squad_duel(first[i], second[i]);
+        if(expected.status() == StatusType::SUCCESS) fought++;
+        if(results[i] != expected.status()) mismatches++;
+        else if(expected.status() == StatusType::SUCCESS && outcomes[i] != expected.ans()) mismatches++;
+    }
+    CHECK(mismatches == 0 && fought > n / 2);
+    CHECK(results[37] == StatusType::INVALID_INPUT && results[38] == StatusType::INVALID_INPUT &&
+          results[39] == StatusType::INVALID_INPUT);
+    CHECK(results[100] == StatusType::FAILURE && results[101] == StatusType::FAILURE &&
+          results[102] == StatusType::FAILURE && results[n - 1] == StatusType::FAILURE);
+    for(int s = 1; s <= 31; s++) CHECK(batch.get_squad_experience(s).ans() == single.get_squad_experience(s).ans());
+    for(int h = 1; h <= 120; h++) CHECK(fightsOf(batch, h) == fightsOf(single, h));
+    CHECK(batch.squad_duels(first, second, 0, nullptr, nullptr) == StatusType::SUCCESS);
+    CHECK(batch.squad_duels(first, second, -1, outcomes, results) == StatusType::INVALID_INPUT);
+}
+
+// a failed add_hunters claims no id and leaves its squad's aura and
+// experience as they were. squad 1 sits one aura point under squad 2, so
+// any aura it kept would swap their ranks
+static void addHuntersAllOrNothing() {
+    Huntech system;
+    NenAbility nen("Manipulator");
+    CHECK(system.add_squad(1) == StatusType::SUCCESS);
+    CHECK(system.add_squad(2) == StatusType::SUCCESS);
+    CHECK(system.add_hunter(1, 1, nen, 10, 0) == StatusType::SUCCESS);
+    CHECK(system.add_hunter(2, 2, nen, 11, 0) == StatusType::SUCCESS);
+    CHECK(system.squad_duel(1, 2).ans() == 3);
+    int experience = system.get_squad_experience(1).ans();
+
+    HunterSpec taken[3] = {{10, nen, 5, 0}, {11, nen, 5, 0}, {2, nen, 5, 0}};
+    HunterSpec repeated[3] = {{10, nen, 5, 0}, {11, nen, 5, 0}, {10, nen, 5, 0}};
+    HunterSpec valid[3] = {{10, nen, 5, 0}, {11, nen, 5, 0}, {12, nen, 5, 0}};
+    HunterSpec negative[3] = {{10, nen, 5, 0}, {11, nen, 5, 0}, {12, nen, -1, 0}};
+    CHECK(system.add_hunters(1, taken, 3) == StatusType::FAILURE);
+    CHECK(system.add_hunters(1, repeated, 3) == StatusType::FAILURE);
+    CHECK(system.add_hunters(3, valid, 3) == StatusType::FAILURE);
+    CHECK(system.add_hunters(1, negative, 3) == StatusType::INVALID_INPUT);
+
+    for(int h = 10; h <= 12; h++) CHECK(system.get_hunter_fights_number(h).status() == StatusType::FAILURE);
+    CHECK(fightsOf(system, 2) == 1);
+    CHECK(system.get_ith_collective_aura_squad(1).ans() == 1);
+    CHECK(system.get_ith_collective_aura_squad(2).ans() == 2);
+    CHECK(system.get_squad_experience(1).ans() == experience);
+    CHECK(system.get_squad_experience(2).ans() == 3);
+
+    // and the ids are free for the batch that fits
+    CHECK(system.add_hunters(1, valid, 3) == StatusType::SUCCESS);
+    CHECK(system.get_ith_collective_aura_squad(2).ans() == 1);
+    for(int h = 10; h <= 12; h++) CHECK(fightsOf(system, h) == 0);
+    CHECK(system.get_squad_experience(1).ans() == experience);
+}
+
+static bool writeRoster(const char* path, const char* text) {
+    FILE* file = fopen(path, "w");
+    if(!file) return false;
+    bool written = fputs(text, file) >= 0;
+    return fclose(file) == 0 && written;
+}
+
+// bulk_load builds its squads from slot 0 and its hunters' ids from
+// scratch, so a system whose squads or hunters were all removed again is
+// refused: the build would write over the free slots and the retired ids
+static void bulkLoadAfterRemovals() {
+    const char* path = "HuntechTest.roster";
+    CHECK(writeRoster(path, "3 1 2 3\n2 10 1 Enhancer 4 0 11 3 Emitter 2 5\n"));
+
+    Huntech fresh;
+    CHECK(fresh.bulk_load(path) == StatusType::SUCCESS);
+    CHECK(fresh.get_squad_experience(1).status() == StatusType::SUCCESS);
+    CHECK(fresh.get_ith_collective_aura_squad(1).ans() == 2);
+    CHECK(fightsOf(fresh, 11) == 5);
+
+    Huntech system;
+    CHECK(system.add_squad(100) == StatusType::SUCCESS);
+    CHECK(system.remove_squad(100) == StatusType::SUCCESS);
+    CHECK(system.bulk_load(path) == StatusType::FAILURE);
+    CHECK(system.add_squad(50) == StatusType::SUCCESS);
+    CHECK(system.get_squad_experience(1).status() == StatusType::FAILURE);
+    CHECK(system.get_squad_experience(50).ans() == 0);
+    CHECK(system.get_ith_collective_aura_squad(1).ans() == 50);
+    CHECK(system.get_ith_collective_aura_squad(2).status() == StatusType::FAILURE);
+
+    // enough hunters for their squad's removal to compact them out of the
+    // union, only their retired ids are left
+    Huntech retired;
+    NenAbility nen("Enhancer");
+    CHECK(retired.add_squad(7) == StatusType::SUCCESS);
+    for(int h = 1; h <= COMPACT_MIN_DEAD; h++) CHECK(retired.add_hunter(h, 7, nen, 1, h) == StatusType::SUCCESS);
+    CHECK(retired.remove_squad(7) == StatusType::SUCCESS);
+    CHECK(retired.bulk_load(path) == StatusType::FAILURE);
+    CHECK(fightsOf(retired, 10) == 10);
+    CHECK(retired.get_squad_experience(1).status() == StatusType::FAILURE);
+    remove(path);
+}
+
+static long readFile(const char* path, unsigned char* bytes, long capacity) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return -1;
+    long size = (long)fread(bytes, 1, (size_t)capacity, file);
+    fclose(file);
+    return size;
+}
+
+static bool writeFile(const char* path, const unsigned char* bytes, long size) {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+    bool written = fwrite(bytes, 1, (size_t)size, file) == (size_t)size;
+    return fclose(file) == 0 && written;
+}
+
+// a damaged snapshot is refused and the system keeps its state: a flipped
+// byte fails the checksum, and a file without one (version 2) whose last
+// squad bucket points past the pool is caught by the bounds checks
+static void corruptSnapshot() {
+    const char* path = "HuntechTest.snapshot";
+    const char* damaged = "HuntechTest.damaged";
+    Huntech saved;
+    NenAbility nen("Conjurer");
+    for(int s = 1; s <= 40; s++) CHECK(saved.add_squad(s) == StatusType::SUCCESS);
+    for(int h = 1; h <= 200; h++) CHECK(saved.add_hunter(h, 1 + h % 40, nen, h, h % 9) == StatusType::SUCCESS);
+    CHECK(saved.squad_duel(1, 2).status() == StatusType::SUCCESS);
+    CHECK(saved.save_snapshot(path) == StatusType::SUCCESS);
+
+    static unsigned char bytes[1 << 16];
+    long size = readFile(path, bytes, sizeof(bytes));
+    CHECK(size > 0 && size < (long)sizeof(bytes));
+
+    Huntech loaded;
+    CHECK(loaded.load_snapshot(path) == StatusType::SUCCESS);
+    CHECK(fightsOf(loaded, 1) == fightsOf(saved, 1));
+
+    Huntech system;
+    CHECK(system.add_squad(7) == StatusType::SUCCESS);
+    bytes[size / 2] ^= 0x40;
+    CHECK(writeFile(damaged, bytes, size));
+    CHECK(system.load_snapshot(damaged) == StatusType::FAILURE);
+    bytes[size / 2] ^= 0x40;
+
+    int version = 2;
+    int outside = 1 << 20;
+    memcpy(bytes + 8, &version, sizeof(version));
+    memcpy(bytes + size - 8 - sizeof(outside), &outside, sizeof(outside));
+    CHECK(writeFile(damaged, bytes, size - 8));
+    CHECK(system.load_snapshot(damaged) == StatusType::FAILURE);
+
+    CHECK(system.get_squad_experience(7).ans() == 0);
+    CHECK(system.get_squad_experience(1).status() == StatusType::FAILURE);
+    remove(path);
+    remove(damaged);
+}
+
+static int denseId(int i) {
+    return i;
+}
+
+static int sparseId(int i) {
+    return 1 + (int)((unsigned int)i * 2654435761u % 2000000000u);
+}
+
+// 60 squads of 50 hunters (ids idOf(1..3000)), duels and force_joins among
+// them, then squads removed: 35 with compact, enough for the union to drop
+// their hunters, 5 without
+static void playSeason(Huntech& system, int (*idOf)(int), bool compact) {
+    const char* types[] = {"Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"};
+    for(int s = 1; s <= 60; s++) CHECK(system.add_squad(s) == StatusType::SUCCESS);
+    for(int h = 1; h <= 3000; h++) {
+        CHECK(system.add_hunter(idOf(h), 1 + h % 60, NenAbility(types[h % 6]), h % 17, h % 5) == StatusType::SUCCESS);
+    }
+    srand(12);
+    for(int i = 0; i < 400; i++) system.squad_duel(1 + rand() % 60, 1 + rand() % 60);
+    int joined = 0;
+    for(int s = 2; s <= 20; s += 3) joined += system.force_join(s, s + 1) == StatusType::SUCCESS;
+    CHECK(joined > 0);
+    for(int i = 0; i < 200; i++) system.squad_duel(1 + rand() % 60, 1 + rand() % 60);
+    int removed = compact ? 35 : 5;
+    for(int s = 60; s > 60 - removed; s--) CHECK(system.remove_squad(s) == StatusType::SUCCESS);
+}
+
+// every query of the two systems answers alike: fights and partial nen of
+// every hunter, experience of squads 1..61 and the whole aura ranking
+static void sameAnswers(Huntech& expected, Huntech& actual, int (*idOf)(int), int hunters) {
+    int mismatches = 0;
+    for(int h = 1; h <= hunters; h++) {
+        if(fightsOf(expected, idOf(h)) != fightsOf(actual, idOf(h))) mismatches++;
+        output_t<NenAbility> nen1 = expected.get_partial_nen_ability(idOf(h));
+        output_t<NenAbility> nen2 = actual.get_partial_nen_ability(idOf(h));
+        if(nen1.status() != nen2.status()) mismatches++;
+        else if(nen1.status() == StatusType::SUCCESS) {
+            NenVector lanes1 = NenVector::fromAbility(nen1.ans());
+            NenVector lanes2 = NenVector::fromAbility(nen2.ans());
+            if(memcmp(lanes1.lanes, lanes2.lanes, sizeof(lanes1.lanes)) != 0) mismatches++;
+        }
+    }
+    for(int s = 1; s <= 61; s++) {
+        output_t<int> exp1 = expected.get_squad_experience(s);
+        output_t<int> exp2 = actual.get_squad_experience(s);
+        if(exp1.status() != exp2.status() || (exp1.status() == StatusType::SUCCESS && exp1.ans() != exp2.ans()))
+            mismatches++;
+    }
+    for(int i = 0; i <= 62; i++) {
+        output_t<int> rank1 = expected.get_ith_collective_aura_squad(i);
+        output_t<int> rank2 = actual.get_ith_collective_aura_squad(i);
+        if(rank1.status() != rank2.status() || (rank1.status() == StatusType::SUCCESS && rank1.ans() != rank2.ans()))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+// a loaded snapshot answers every query as the system it was saved from,
+// with dense and hashed hunter ids and after a compaction, and both go on
+// alike: new hunters, duels, a force_join and removals on top of it
+static void snapshotRoundTrip() {
+    const char* path = "HuntechTest.snapshot";
+    int (*idsOf[2])(int) = {denseId, sparseId};
+    for(int ids = 0; ids < 2; ids++) {
+        for(int compact = 0; compact < 2; compact++) {
+            int (*idOf)(int) = idsOf[ids];
+            Huntech saved;
+            playSeason(saved, idOf, compact == 1);
+            CHECK(saved.save_snapshot(path) == StatusType::SUCCESS);
+            Huntech loaded;
+            CHECK(loaded.add_squad(99) == StatusType::SUCCESS);
+            CHECK(loaded.load_snapshot(path) == StatusType::SUCCESS);
+            sameAnswers(saved, loaded, idOf, 3000);
+
+            // the same calls on both, with the same answers
+            int differ = 0;
+            CHECK(saved.add_squad(61) == StatusType::SUCCESS && loaded.add_squad(61) == StatusType::SUCCESS);
+            for(int h = 3001; h <= 3100; h++) {
+                NenAbility nen("Emitter");
+                differ += saved.add_hunter(idOf(h), 1 + h % 61, nen, h % 11, 0) !=
+                          loaded.add_hunter(idOf(h), 1 + h % 61, nen, h % 11, 0);
+            }
+            CHECK(loaded.add_hunter(idOf(7), 61, NenAbility("Emitter"), 1, 0) == StatusType::FAILURE);
+            srand(31);
+            for(int i = 0; i < 100; i++) {
+                int first = 1 + rand() % 61;
+                int second = 1 + rand() % 61;
+                output_t<int> outcome1 = saved.squad_duel(first, second);
+                output_t<int> outcome2 = loaded.squad_duel(first, second);
+                differ += outcome1.status() != outcome2.status() ||
+                          (outcome1.status() == StatusType::SUCCESS && outcome1.ans() != outcome2.ans());
+            }
+            for(int s = 1; s <= 61; s += 4) differ += saved.force_join(61, s) != loaded.force_join(61, s);
+            for(int s = 2; s <= 61; s += 5) differ += saved.remove_squad(s) != loaded.remove_squad(s);
+            CHECK(differ == 0);
+            sameAnswers(saved, loaded, idOf, 3100);
+        }
+    }
+    remove(path);
+}
+
+static int intAt(const unsigned char* bytes, long pos) {
+    int value;
+    memcpy(&value, bytes + pos, sizeof(value));
+    return value;
+}
+
+static void setIntAt(unsigned char* bytes, long pos, int value) {
+    memcpy(bytes + pos, &value, sizeof(value));
+}
+
+// where the parts of a version 3 snapshot sit, read off the file itself
+struct SnapshotMap {
+    int ulink, uset, nen, hunter, squad;
+    int nodes;
+    long links, sets;
+    int slots;
+    long pool, squads;
+};
+
+// the int fields of a Squad record, in declaration order
+enum { SQUAD_ID, SQUAD_HEAD, SQUAD_HASH_NEXT, SQUAD_HASH_PREV, SQUAD_PARENT, SQUAD_LEFT, SQUAD_RIGHT,
+       SQUAD_HEIGHT, SQUAD_WEIGHT, SQUAD_AURA };
+
+static SnapshotMap mapSnapshot(const unsigned char* bytes) {
+    SnapshotMap map;
+    // magic, version, byte order and layout size, then the layout and the lsn
+    map.ulink = intAt(bytes, 24);
+    map.uset = intAt(bytes, 28);
+    map.nen = intAt(bytes, 32);
+    map.hunter = intAt(bytes, 36);
+    map.squad = intAt(bytes, 40);
+    long pos = 52;
+    bool sparse = intAt(bytes, pos) == 1;
+    int capacity = intAt(bytes, pos + 8);
+    pos += sparse ? 16 + (1 + 8) * (long)capacity : 12 + 4 * (long)capacity;
+    map.nodes = intAt(bytes, pos);
+    map.links = pos + 8;
+    map.sets = map.links + (long)map.nodes * (map.ulink + 4 + map.nen);
+    map.pool = map.sets + (long)map.nodes * (map.uset + map.hunter);
+    map.slots = intAt(bytes, map.pool);
+    map.squads = map.pool + 20;
+    return map;
+}
+
+static long squadField(const SnapshotMap& map, int slot, int field) {
+    return map.squads + (long)slot * map.squad + 4 * field;
+}
+
+// writes the first size bytes with a fresh checksum after them and loads it
+static StatusType loadResealed(Huntech& system, const unsigned char* bytes, long size) {
+    const char* damaged = "HuntechTest.damaged";
+    SnapshotChecksum sum;
+    sum.add(bytes, (size_t)size);
+    unsigned long long value = sum.value();
+    FILE* file = fopen(damaged, "wb");
+    if(!file) return StatusType::ALLOCATION_ERROR;
+    fwrite(bytes, 1, (size_t)size, file);
+    fwrite(&value, 1, sizeof(value), file);
+    fclose(file);
+    StatusType result = system.load_snapshot(damaged);
+    remove(damaged);
+    return result;
+}
+
+// a snapshot whose checksum holds but whose structures do not is refused,
+// one case per check, and the system keeps its state
+static void inconsistentSnapshot() {
+    const char* path = "HuntechTest.snapshot";
+    Huntech saved;
+    NenAbility nen("Transmuter");
+    for(int s = 1; s <= 40; s++) CHECK(saved.add_squad(s) == StatusType::SUCCESS);
+    for(int h = 1; h <= 200; h++) CHECK(saved.add_hunter(h, 1 + h % 40, nen, h, h % 9) == StatusType::SUCCESS);
+    int joined = 0;
+    for(int s = 3; s <= 30 && joined == 0; s++) joined += saved.force_join(s + 1, s) == StatusType::SUCCESS;
+    CHECK(joined == 1);
+    CHECK(saved.squad_duel(1, 2).status() == StatusType::SUCCESS);
+    CHECK(saved.remove_squad(39) == StatusType::SUCCESS);
+    CHECK(saved.remove_squad(40) == StatusType::SUCCESS);
+    CHECK(saved.save_snapshot(path) == StatusType::SUCCESS);
+    static unsigned char pristine[1 << 16];
+    static unsigned char bytes[1 << 16];
+    long size = readFile(path, pristine, sizeof(pristine)) - 8;
+    CHECK(size > 0 && size < (long)sizeof(pristine) - 8);
+    remove(path);
+    SnapshotMap map = mapSnapshot(pristine);
+
+    // the slots the cases pick: a free one, the aura root and a leaf under
+    // it, and squad 1 whose head has a child
+    int freeHead = intAt(pristine, map.pool + 12);
+    int root = intAt(pristine, map.pool + 16);
+    int leaf = root;
+    while(intAt(pristine, squadField(map, leaf, SQUAD_LEFT)) != -1) leaf = intAt(pristine, squadField(map, leaf, SQUAD_LEFT));
+    int slot1 = -1;
+    for(int slot = 0; slot < map.slots; slot++) {
+        if(intAt(pristine, squadField(map, slot, SQUAD_ID)) == 1) slot1 = slot;
+    }
+    int head = intAt(pristine, squadField(map, slot1, SQUAD_HEAD));
+    int otherHead = intAt(pristine, squadField(map, root, SQUAD_HEAD));
+    int child = -1;
+    for(int node = 0; node < map.nodes; node++) {
+        if(node != head && intAt(pristine, map.links + 8L * node) == head) child = node;
+    }
+    CHECK(freeHead != -1 && leaf != root && slot1 != -1 && child != -1 && head != otherHead);
+    // the map reads the file right: a head is its own parent, the root has
+    // none and weighs every live squad
+    CHECK(intAt(pristine, map.links + 8L * head) == head);
+    CHECK(intAt(pristine, squadField(map, root, SQUAD_PARENT)) == -1);
+    CHECK(intAt(pristine, squadField(map, root, SQUAD_WEIGHT)) == 37);
+    CHECK(intAt(pristine, squadField(map, freeHead, SQUAD_ID)) == 0);
+
+    // the file as saved loads through the same path
+    Huntech intact;
+    memcpy(bytes, pristine, (size_t)size);
+    CHECK(loadResealed(intact, bytes, size) == StatusType::SUCCESS);
+    CHECK(fightsOf(intact, 3) == fightsOf(saved, 3));
+
+    Huntech system;
+    CHECK(system.add_squad(7) == StatusType::SUCCESS);
+
+    struct Corruption {
+        long pos;
+        int value;
+    };
+    const Corruption cases[] = {
+        // a parent cycle between squad 1's head and its child
+        {map.links + 8L * head, child},
+        // a root's size that is not its number of nodes
+        {map.links + 8L * head + 4, intAt(pristine, map.links + 8L * head + 4) + 1},
+        // a lastChrono out of range, and one in another set
+        {map.sets + (long)map.uset * head + 4, map.nodes},
+        {map.sets + (long)map.uset * head + 4, otherHead},
+        // a squad head that is not the root of its set
+        {squadField(map, slot1, SQUAD_HEAD), child},
+        // the aura root's weight, a leaf's height
+        {squadField(map, root, SQUAD_WEIGHT), intAt(pristine, squadField(map, root, SQUAD_WEIGHT)) + 1},
+        {squadField(map, leaf, SQUAD_HEIGHT), 1},
+        // the root's aura below its left subtree's
+        {squadField(map, root, SQUAD_AURA), -1000000},
+        // a hash chain that loops on itself, an aura tree that loops to its root
+        {squadField(map, slot1, SQUAD_HASH_NEXT), slot1},
+        {squadField(map, leaf, SQUAD_LEFT), root},
+        // the free list starting at a live squad
+        {map.pool + 12, slot1},
+    };
+    for(const Corruption& corruption : cases) {
+        memcpy(bytes, pristine, (size_t)size);
+        setIntAt(bytes, corruption.pos, corruption.value);
+        CHECK(loadResealed(system, bytes, size) == StatusType::FAILURE);
+    }
+
+    // a version 2 file has no checksum to stop the cycle, the checks still do
+    memcpy(bytes, pristine, (size_t)size);
+    setIntAt(bytes, 8, SNAPSHOT_VERSION_NO_CHECKSUM);
+    setIntAt(bytes, map.links + 8L * head, child);
+    CHECK(writeFile(path, bytes, size));
+    CHECK(system.load_snapshot(path) == StatusType::FAILURE);
+    setIntAt(bytes, map.links + 8L * head, head);
+    CHECK(writeFile(path, bytes, size));
+    CHECK(intact.load_snapshot(path) == StatusType::SUCCESS);
+    remove(path);
+
+    CHECK(system.get_squad_experience(7).ans() == 0);
+    CHECK(system.get_squad_experience(1).status() == StatusType::FAILURE);
+    CHECK(system.get_ith_collective_aura_squad(2).status() == StatusType::FAILURE);
+}
+
+// a hashed index whose capacity is not prime, or that holds a key where its
+// probe does not reach it, is refused
+static void inconsistentTable() {
+    const char* path = "HuntechTest.table";
+    const int capacities[3] = {11, 12, 11};
+    for(int c = 0; c < 3; c++) {
+        int capacity = capacities[c];
+        unsigned char status[12] = {0};
+        int keys[12] = {0};
+        int values[12] = {0};
+        // key 5 lives at slot 5, in the third case at slot 6 behind an empty slot 5
+        int slot = c == 2 ? 6 : 5;
+        status[slot] = OCCUPIED;
+        keys[slot] = 5;
+        values[slot] = 50;
+        {
+            SnapshotWriter out(path);
+            out.writeInt(capacity);
+            out.writeInt(1);
+            out.write(status, (size_t)capacity);
+            out.write(keys, sizeof(int) * capacity);
+            out.write(values, sizeof(int) * capacity);
+            CHECK(out.commit());
+        }
+        DoubleHashTable<int, int> table;
+        table.insert(1, 10);
+        SnapshotReader in(path);
+        bool refused = false;
+        try {
+            table.load(in);
+        }
+        catch(StatusType) {
+            refused = true;
+        }
+        CHECK(refused == (c != 0));
+        CHECK(table.find(5) == (c == 0 ? 50 : -1));
+        CHECK(table.find(1) == (c == 0 ? -1 : 10));
+    }
+    remove(path);
+}
+
+// some of every logged change on squads first..first+9 and hunters
+// from hunter on, as they come to a system that may hold others
+static void playLogged(Huntech& system, int first, int hunter) {
+    const char* types[] = {"Enhancer", "Emitter", "Transmuter", "Conjurer", "Manipulator", "Specialist"};
+    for(int s = first; s < first + 10; s++) CHECK(system.add_squad(s) == StatusType::SUCCESS);
+    for(int h = hunter; h < hunter + 40; h++) {
+        CHECK(system.add_hunter(h, first + h % 10, NenAbility(types[h % 6]), h % 7, h % 3) == StatusType::SUCCESS);
+    }
+    for(int i = 0; i < 20; i++) system.squad_duel(first + i % 10, first + (i * 3 + 1) % 10);
+    for(int s = first; s < first + 10; s += 2) system.force_join(s + 1, s);
+    CHECK(system.remove_squad(first + 9) == StatusType::SUCCESS);
+}
+
+// the state before a failed recover: squad 7 with hunter 700
+static void checkUntouched(Huntech& system) {
+    CHECK(fightsOf(system, 700) == 4);
+    CHECK(system.get_ith_collective_aura_squad(1).ans() == 7);
+    CHECK(system.get_ith_collective_aura_squad(2).status() == StatusType::FAILURE);
+    CHECK(system.get_squad_experience(1).status() == StatusType::FAILURE);
+}
+
+// recover rebuilds the state from a snapshot and the log after it, or from
+// the log alone, and drops a torn last record. a log that starts past the
+// snapshot's lsn or holds a record that does not apply gives FAILURE and
+// leaves the system as it was
+static void recoverFromLog() {
+    const char* snapshot = "HuntechTest.snapshot";
+    const char* beforeLast = "HuntechTest.before";
+    const char* path = "HuntechTest.log";
+    const char* other = "HuntechTest.other";
+    remove(path);
+    remove(other);
+    Huntech live;
+    CHECK(live.open_log(path, 4, 0) == StatusType::SUCCESS);
+    playLogged(live, 1, 1);
+    CHECK(live.close_log() == StatusType::SUCCESS);
+    long long snapshotLsn = live.last_lsn();
+    CHECK(live.save_snapshot(snapshot) == StatusType::SUCCESS);
+    CHECK(live.open_log(path, 4, 0) == StatusType::SUCCESS);
+    playLogged(live, 11, 41);
+    CHECK(live.save_snapshot(beforeLast) == StatusType::SUCCESS);
+    CHECK(live.add_squad(21) == StatusType::SUCCESS);
+    CHECK(live.close_log() == StatusType::SUCCESS);
+
+    Huntech fromSnapshot;
+    CHECK(fromSnapshot.recover(snapshot, path) == StatusType::SUCCESS);
+    CHECK(fromSnapshot.last_lsn() == live.last_lsn());
+    sameAnswers(live, fromSnapshot, denseId, 80);
+    Huntech fromLog;
+    CHECK(fromLog.add_squad(7) == StatusType::SUCCESS);
+    CHECK(fromLog.recover(nullptr, path) == StatusType::SUCCESS);
+    CHECK(fromLog.last_lsn() == live.last_lsn());
+    sameAnswers(live, fromLog, denseId, 80);
+
+    // the last record cut short, recover ends before it
+    static unsigned char bytes[1 << 16];
+    long size = readFile(path, bytes, sizeof(bytes));
+    CHECK(size > 0 && size < (long)sizeof(bytes));
+    CHECK(writeFile(other, bytes, size - 3));
+    Huntech torn;
+    CHECK(torn.recover(nullptr, other) == StatusType::SUCCESS);
+    CHECK(torn.last_lsn() == live.last_lsn() - 1);
+    Huntech before;
+    CHECK(before.load_snapshot(beforeLast) == StatusType::SUCCESS);
+    sameAnswers(before, torn, denseId, 80);
+    CHECK(torn.get_squad_experience(21).status() == StatusType::FAILURE);
+    remove(other);
+
+    Huntech system;
+    CHECK(system.add_squad(7) == StatusType::SUCCESS);
+    CHECK(system.add_hunter(700, 7, NenAbility("Emitter"), 1, 4) == StatusType::SUCCESS);
+
+    // a log whose first record comes two past the snapshot's lsn
+    Huntech ahead;
+    for(int s = 100; ahead.last_lsn() < snapshotLsn + 1; s++) CHECK(ahead.add_squad(s) == StatusType::SUCCESS);
+    CHECK(ahead.open_log(other, 1, 0) == StatusType::SUCCESS);
+    CHECK(ahead.add_squad(51) == StatusType::SUCCESS);
+    CHECK(ahead.close_log() == StatusType::SUCCESS);
+    CHECK(system.recover(snapshot, other) == StatusType::FAILURE);
+    checkUntouched(system);
+    remove(other);
+
+    // a log that follows the snapshot's lsn but not its state: its hunter
+    // joins a squad the snapshot never had, after a record that applies
+    Huntech diverged;
+    for(int s = 100; diverged.last_lsn() < snapshotLsn; s++) CHECK(diverged.add_squad(s) == StatusType::SUCCESS);
+    CHECK(diverged.open_log(other, 1, 0) == StatusType::SUCCESS);
+    CHECK(diverged.add_squad(22) == StatusType::SUCCESS);
+    CHECK(diverged.add_hunter(2000, 100, NenAbility("Emitter"), 1, 0) == StatusType::SUCCESS);
+    CHECK(diverged.close_log() == StatusType::SUCCESS);
+    CHECK(system.recover(snapshot, other) == StatusType::FAILURE);
+    checkUntouched(system);
+
+    remove(snapshot);
+    remove(beforeLast);
+    remove(path);
+    remove(other);
+}
+
+// a record the log cannot take fails its change and ends a batch there.
+// the log file is capped with RLIMIT_FSIZE so that only two duel records
+// (13 bytes each) fit after the 24 byte header, and each is fsynced alone
+static void logFailureStopsBatch() {
+#if defined(__unix__) || defined(__APPLE__)
+    const char* path = "HuntechTest.log";
+    remove(path);
+    Huntech system;
+    NenAbility nen("Specialist");
+    for(int s = 1; s <= 4; s++) {
+        CHECK(system.add_squad(s) == StatusType::SUCCESS);
+        CHECK(system.add_hunter(s, s, nen, s, 0) == StatusType::SUCCESS);
+    }
+    CHECK(system.open_log(path, 1, 0) == StatusType::SUCCESS);
+
+    struct rlimit old;
+    CHECK(getrlimit(RLIMIT_FSIZE, &old) == 0);
+    struct rlimit capped = old;
+    capped.rlim_cur = 24 + 2 * 13;
+    void (*oldHandler)(int) = signal(SIGXFSZ, SIG_IGN);
+    CHECK(setrlimit(RLIMIT_FSIZE, &capped) == 0);
+
+    int first[5] = {1, 2, 3, 1, 2};
+    int second[5] = {2, 3, 4, 3, 4};
+    int outcomes[5];
+    StatusType results[5];
+    CHECK(system.squad_duels(first, second, 5, outcomes, results) == StatusType::FAILURE);
+    CHECK(results[0] == StatusType::SUCCESS && results[1] == StatusType::SUCCESS);
+    CHECK(results[2] == StatusType::FAILURE && results[3] == StatusType::FAILURE &&
+          results[4] == StatusType::FAILURE);
+    // the third duel was fought but not logged, the fourth never was
+    CHECK(fightsOf(system, 3) == 2);
+    CHECK(fightsOf(system, 1) == 1);
+    CHECK(system.durable_lsn() == 8 + 2);
+    CHECK(system.add_squad(9) == StatusType::FAILURE);
+
+    setrlimit(RLIMIT_FSIZE, &old);
+    signal(SIGXFSZ, oldHandler);
+    CHECK(system.close_log() == StatusType::FAILURE);
+    remove(path);
+#endif
+}
+
+// a record waiting under a window on a quiet log is synced by poll_log
+// once the window passed, and not before
+static void pollSyncsQuietWindow() {
+    const char* path = "HuntechTest.log";
+    remove(path);
+    Huntech system;
+    CHECK(system.open_log(path, 1 << 30, 2000) == StatusType::SUCCESS);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(system.add_squad(1) == StatusType::SUCCESS);
+    CHECK(system.poll_log() == StatusType::SUCCESS);
+    // only checked when the window surely has not passed yet
+    if(std::chrono::steady_clock::now() - start < std::chrono::microseconds(2000)) CHECK(system.durable_lsn() == 0);
+    while(std::chrono::steady_clock::now() - start < std::chrono::microseconds(3000)) {}
+    CHECK(system.poll_log() == StatusType::SUCCESS);
+    CHECK(system.durable_lsn() == 1);
+    CHECK(system.close_log() == StatusType::SUCCESS);
+    remove(path);
+}
+
+int main() {
+    compactExtremeFights();
+    squadDuelsMatchSingle();
+    addHuntersAllOrNothing();
+    bulkLoadAfterRemovals();
+    corruptSnapshot();
+    snapshotRoundTrip();
+    inconsistentSnapshot();
+    inconsistentTable();
+    recoverFromLog();
+    logFailureStopsBatch();
+    pollSyncsQuietWindow();
+    return checkResult();
+}
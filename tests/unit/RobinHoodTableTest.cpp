@@ -0,0 +1,50 @@
+// RobinHoodTable against a flat array over a small key range, so that long
+// runs, wraparound, rehashes and backward shifts all happen
+#include <cstdio>
+#include <cstdlib>
+#include "RobinHoodTable.h"
+#include "Check.h"
+
+#define KEYS 5000
+
+int main() {
+    srand(7);
+    static int expected[KEYS + 1];
+    for (int k = 0; k <= KEYS; k++) expected[k] = -1;
+    int present = 0;
+    RobinHoodTable<int, int> table;
+
+    for (int step = 0; step < 400000; step++) {
+        int key = 1 + rand() % KEYS;
+        int op = rand() % 3;
+        if (op == 0) {
+            bool inserted = false;
+            int& value = table.try_emplace(key, inserted);
+            CHECK(inserted == (expected[key] == -1));
+            if (inserted) {
+                CHECK(value == 0);
+                present++;
+            }
+            else CHECK(value == expected[key]);
+            value = step;
+            expected[key] = step;
+        }
+        else if (op == 1) {
+            if (expected[key] != -1) present--;
+            table.remove(key);
+            expected[key] = -1;
+        }
+        else CHECK(table.find(key) == expected[key]);
+        CHECK(table.count() == present);
+    }
+    for (int k = 1; k <= KEYS; k++) CHECK(table.find(k) == expected[k]);
+    CHECK(table.find(0) == -1);
+    CHECK(table.maxProbeLength() >= 1);
+    CHECK(table.averageProbeLength() >= 1 && table.averageProbeLength() <= table.maxProbeLength());
+
+    // remove everything, the table must end with no entries at all
+    for (int k = 1; k <= KEYS; k++) table.remove(k);
+    CHECK(table.count() == 0 && table.maxProbeLength() == 0);
+
+    return checkResult();
+}
@@ -0,0 +1,170 @@
+// SquadPool: every AVL rotation on insert and on remove, ranks against a
+// sorted oracle under random churn, free slots reused and the buckets grown.
+// valid() is checked after each step, it fails on a missed rotation
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "SquadPool.h"
+#include "Check.h"
+
+// the ids of the pool ranked by (aura 0, id) are exactly ids, sorted
+static void ranked(const SquadPool& pool, const int* ids, int n) {
+    CHECK(pool.valid());
+    CHECK(pool.size() == n);
+    for (int i = 0; i < n; i++) CHECK(pool.ith_by_aura(i + 1) == ids[i]);
+}
+
+// three inserts that unbalance the root: ascending (left rotation),
+// descending (right), then the two zigzags
+static void insertRotations() {
+    const int orders[4][3] = {{10, 20, 30}, {30, 20, 10}, {10, 30, 20}, {30, 10, 20}};
+    const int sorted[3] = {10, 20, 30};
+    for (const int* order : orders) {
+        SquadPool pool;
+        for (int k = 0; k < 3; k++) {
+            pool.insert(order[k]);
+            CHECK(pool.valid());
+        }
+        ranked(pool, sorted, 3);
+    }
+}
+
+// a four squad tree, then a remove on the short side: the leaf left on the
+// long side makes it a single rotation (outer leaf) or a double (inner leaf)
+static void removeRotations() {
+    struct Case {
+        int extra;
+        int removed;
+        int left[3];
+    };
+    const Case cases[4] = {
+        {40, 10, {20, 30, 40}},
+        {5, 30, {5, 10, 20}},
+        {15, 30, {10, 15, 20}},
+        {25, 10, {20, 25, 30}},
+    };
+    for (const Case& test : cases) {
+        SquadPool pool;
+        const int ids[4] = {20, 10, 30, test.extra};
+        for (int id : ids) pool.insert(id);
+        CHECK(pool.valid());
+        pool.remove(pool.find(test.removed));
+        ranked(pool, test.left, 3);
+        CHECK(pool.find(test.removed) == -1);
+    }
+}
+
+struct Entry {
+    int aura;
+    int id;
+};
+
+static bool byAura(const Entry& a, const Entry& b) {
+    return a.aura != b.aura ? a.aura < b.aura : a.id < b.id;
+}
+
+// random inserts, removes and aura changes with a few equal auras, every
+// rank checked against the live squads sorted by (aura, id)
+static void randomChurn() {
+    const int maxId = 3000;
+    int* aura = new int[maxId + 1];
+    bool* live = new bool[maxId + 1]();
+    Entry* sorted = new Entry[maxId];
+    SquadPool pool;
+    srand(17);
+    int mismatches = 0;
+    for (int step = 1; step <= 20000; step++) {
+        int id = 1 + rand() % maxId;
+        int op = rand() % 3;
+        if (!live[id]) {
+            pool.insert(id);
+            live[id] = true;
+            aura[id] = 0;
+        }
+        else if (op == 0) {
+            pool.remove(pool.find(id));
+            live[id] = false;
+        }
+        else {
+            aura[id] = rand() % 50 - 10;
+            pool.setAura(pool.find(id), aura[id]);
+        }
+        if (step % 2000 != 0) continue;
+        CHECK(pool.valid());
+        int n = 0;
+        for (int i = 1; i <= maxId; i++) {
+            if (live[i]) sorted[n++] = {aura[i], i};
+        }
+        std::sort(sorted, sorted + n, byAura);
+        CHECK(pool.size() == n);
+        for (int i = 0; i < n; i++) {
+            if (pool.ith_by_aura(i + 1) != sorted[i].id) mismatches++;
+            if (pool[pool.find(sorted[i].id)].totalAura != sorted[i].aura) mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+    bool thrown = false;
+    try {
+        pool.ith_by_aura(pool.size() + 1);
+    }
+    catch (StatusType) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    delete[] aura;
+    delete[] live;
+    delete[] sorted;
+}
+
+// a removed squad's slot goes to the next insert, the pool does not grow
+static void freeSlotReuse() {
+    SquadPool pool;
+    for (int id = 1; id <= 10; id++) CHECK(pool.insert(id) == id - 1);
+    pool.remove(pool.find(4));
+    pool.remove(pool.find(8));
+    CHECK(pool.valid());
+    CHECK(pool[3].getId() == 0 && pool[7].getId() == 0);
+    int first = pool.insert(11);
+    int second = pool.insert(12);
+    CHECK((first == 7 && second == 3) || (first == 3 && second == 7));
+    CHECK(pool.slots() == 10);
+    CHECK(pool.insert(13) == 10);
+    CHECK(pool.valid());
+    CHECK(pool.find(4) == -1 && pool.find(8) == -1);
+    CHECK(pool.find(11) == first && pool.find(12) == second);
+}
+
+// odd i as they are, even ones spread up to 2e9, all distinct
+static int mixedId(int i) {
+    return i % 2 ? i : i * 40000 + 1;
+}
+
+// far more squads than the first buckets, ids close together and spread
+// out, then most of them removed
+static void bucketGrowth() {
+    SquadPool pool;
+    const int n = 50000;
+    for (int i = 1; i <= n; i++) pool.insert(mixedId(i));
+    CHECK(pool.valid());
+    int missing = 0;
+    for (int i = 1; i <= n; i++) {
+        int id = mixedId(i);
+        int slot = pool.find(id);
+        if (slot == -1 || pool[slot].getId() != id) missing++;
+    }
+    CHECK(missing == 0);
+    for (int i = 1; i <= n; i += 2) {
+        if (i % 3 != 0) pool.remove(pool.find(i));
+    }
+    CHECK(pool.valid());
+    for (int i = 1; i <= n; i += 2) CHECK((pool.find(i) == -1) == (i % 3 != 0));
+}
+
+int main() {
+    insertRotations();
+    removeRotations();
+    randomChurn();
+    freeSlotReuse();
+    bucketGrowth();
+    return checkResult();
+}